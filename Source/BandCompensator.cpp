@@ -0,0 +1,338 @@
+/*
+  ==============================================================================
+
+    BandCompensator.cpp
+
+  ==============================================================================
+*/
+
+#include "BandCompensator.h"
+#include "RealtimeSafety.h"
+
+namespace
+{
+    /** Gain the unit responses are measured at; the iterations correct for
+        the response not scaling exactly with gain.
+    */
+    constexpr double referenceGainDecibels = 6.0;
+
+    /** Solves A x = b in place for a symmetric positive definite A, already
+        Cholesky-factored into its lower triangle.
+    */
+    void solveCholesky (const std::vector<double>& factor, int size, double* b) noexcept
+    {
+        for (int i = 0; i < size; ++i)
+        {
+            auto sum = b[i];
+
+            for (int k = 0; k < i; ++k)
+                sum -= factor[(size_t) (i * size + k)] * b[k];
+
+            b[i] = sum / factor[(size_t) (i * size + i)];
+        }
+
+        for (int i = size; --i >= 0;)
+        {
+            auto sum = b[i];
+
+            for (int k = i + 1; k < size; ++k)
+                sum -= factor[(size_t) (k * size + i)] * b[k];
+
+            b[i] = sum / factor[(size_t) (i * size + i)];
+        }
+    }
+
+    void factorCholesky (std::vector<double>& matrix, int size) noexcept
+    {
+        for (int j = 0; j < size; ++j)
+        {
+            auto diagonal = matrix[(size_t) (j * size + j)];
+
+            for (int k = 0; k < j; ++k)
+                diagonal -= matrix[(size_t) (j * size + k)] * matrix[(size_t) (j * size + k)];
+
+            diagonal = std::sqrt (juce::jmax (diagonal, 1.0e-12));
+            matrix[(size_t) (j * size + j)] = diagonal;
+
+            for (int i = j + 1; i < size; ++i)
+            {
+                auto sum = matrix[(size_t) (i * size + j)];
+
+                for (int k = 0; k < j; ++k)
+                    sum -= matrix[(size_t) (i * size + k)] * matrix[(size_t) (j * size + k)];
+
+                matrix[(size_t) (i * size + j)] = sum / diagonal;
+            }
+        }
+    }
+}
+
+//==============================================================================
+void CompensationSolver::compensate (ChainSettings& settings, double sampleRate)
+{
+    if (settings.bandMode != model.layout.bandMode || sampleRate != model.sampleRate)
+        buildModel (settings.bandMode, sampleRate);
+
+    auto& gains = settings.peakGainInDecibels;
+
+    for (int point = 0; point < model.numPoints; ++point)
+    {
+        auto lower = model.lowerBand[(size_t) point];
+        auto weight = model.upperWeight[(size_t) point];
+        target[(size_t) point] = gains[(size_t) lower] + (gains[(size_t) juce::jmin (lower + 1, model.numBands - 1)] - gains[(size_t) lower]) * weight;
+    }
+
+    // A linear first guess from the unit responses, then Gauss-Newton style
+    // corrections against the real, slightly non-linear, response
+    std::fill (gains.begin(), gains.end(), 0.0f);
+    project (target, gains);
+
+    for (int iteration = 0; iteration < maximumIterations; ++iteration)
+    {
+        evaluateResponse (gains, error);
+
+        for (int point = 0; point < model.numPoints; ++point)
+            error[(size_t) point] = target[(size_t) point] - error[(size_t) point];
+
+        // Converged once the corrections stop moving any band noticeably
+        if (project (error, gains) < toleranceDecibels)
+            break;
+    }
+}
+
+void CompensationSolver::buildModel (BandMode mode, double sampleRate)
+{
+    auto table = getBandTable (mode);
+    auto numBands = table.numBands;
+
+    model.layout.bandMode = mode;
+    model.sampleRate = sampleRate;
+    model.numBands = numBands;
+    model.zInverse.clear();
+    model.lowerBand.clear();
+    model.upperWeight.clear();
+    model.fitWeight.clear();
+
+    // Points spread evenly over log frequency from the first band centre to
+    // the last, as far as Nyquist allows
+    auto lowest = table.bands[0].frequency;
+    auto highest = table.bands[numBands - 1].frequency;
+    auto maximumPoints = pointsPerBand * (numBands - 1) + 1;
+    auto band = 0;
+
+    for (int i = 0; i < maximumPoints; ++i)
+    {
+        auto frequency = lowest * std::pow (highest / lowest, (double) i / (maximumPoints - 1));
+
+        if (frequency >= sampleRate * 0.49)
+            break;
+
+        while (band < numBands - 2 && frequency > table.bands[band + 1].frequency)
+            ++band;
+
+        auto weight = std::log (frequency / table.bands[band].frequency)
+                    / std::log (table.bands[band + 1].frequency / table.bands[band].frequency);
+
+        model.zInverse.push_back (std::polar (1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate));
+        model.lowerBand.push_back (band);
+        model.upperWeight.push_back (juce::jlimit (0.0, 1.0, weight));
+        model.fitWeight.push_back (i % pointsPerBand == 0 ? 1.0 : betweenCentresWeight);
+    }
+
+    auto numPoints = (int) model.zInverse.size();
+    model.numPoints = numPoints;
+    target.assign ((size_t) numPoints, 0.0);
+    error.assign ((size_t) numPoints, 0.0);
+
+    // Unit responses: dB per dB of gain for each band at each point
+    std::vector<double> basis ((size_t) (numPoints * numBands));
+
+    for (int b = 0; b < numBands; ++b)
+    {
+        auto coefficients = CoefficientEngine::designStage (sampleRate, model.layout, getPeakStage (b), referenceGainDecibels);
+
+        for (int point = 0; point < numPoints; ++point)
+            basis[(size_t) (point * numBands + b)] = 20.0 * std::log10 (coefficients.getMagnitude (model.zInverse[(size_t) point]))
+                                                   / referenceGainDecibels;
+    }
+
+    // Weighted normal equations with a little Tikhonov damping, so heavily
+    // overlapping bands can't trade huge opposite gains for a tiny improvement in fit
+    std::vector<double> normal ((size_t) (numBands * numBands), 0.0);
+
+    for (int i = 0; i < numBands; ++i)
+        for (int j = 0; j <= i; ++j)
+        {
+            auto sum = 0.0;
+
+            for (int point = 0; point < numPoints; ++point)
+                sum += model.fitWeight[(size_t) point] * basis[(size_t) (point * numBands + i)] * basis[(size_t) (point * numBands + j)];
+
+            normal[(size_t) (i * numBands + j)] = normal[(size_t) (j * numBands + i)] = sum;
+        }
+
+    auto trace = 0.0;
+
+    for (int i = 0; i < numBands; ++i)
+        trace += normal[(size_t) (i * numBands + i)];
+
+    for (int i = 0; i < numBands; ++i)
+        normal[(size_t) (i * numBands + i)] += 1.0e-3 * trace / numBands;
+
+    factorCholesky (normal, numBands);
+
+    // pseudoInverse = (B'WB + lambda I)^-1 B'W, one column per point
+    model.pseudoInverse.assign ((size_t) (numBands * numPoints), 0.0);
+    std::vector<double> column ((size_t) numBands);
+
+    for (int point = 0; point < numPoints; ++point)
+    {
+        for (int b = 0; b < numBands; ++b)
+            column[(size_t) b] = model.fitWeight[(size_t) point] * basis[(size_t) (point * numBands + b)];
+
+        solveCholesky (normal, numBands, column.data());
+
+        for (int b = 0; b < numBands; ++b)
+            model.pseudoInverse[(size_t) (b * numPoints + point)] = column[(size_t) b];
+    }
+}
+
+float CompensationSolver::project (const std::vector<double>& values, std::array<float, maxPeakBands>& gains) const noexcept
+{
+    auto largestChange = 0.0f;
+
+    for (int b = 0; b < model.numBands; ++b)
+    {
+        auto* row = model.pseudoInverse.data() + b * model.numPoints;
+        auto sum = 0.0;
+
+        for (int point = 0; point < model.numPoints; ++point)
+            sum += row[point] * values[(size_t) point];
+
+        auto newGain = juce::jlimit (-maximumGainDecibels, maximumGainDecibels, gains[(size_t) b] + (float) sum);
+        largestChange = juce::jmax (largestChange, std::abs (newGain - gains[(size_t) b]));
+        gains[(size_t) b] = newGain;
+    }
+
+    return largestChange;
+}
+
+void CompensationSolver::evaluateResponse (const std::array<float, maxPeakBands>& gains, std::vector<double>& destination) const noexcept
+{
+    std::fill (destination.begin(), destination.end(), 0.0);
+
+    for (int b = 0; b < model.numBands; ++b)
+    {
+        if (gains[(size_t) b] == 0.0f)
+            continue;
+
+        auto coefficients = CoefficientEngine::designStage (model.sampleRate, model.layout, getPeakStage (b), gains[(size_t) b]);
+
+        for (int point = 0; point < model.numPoints; ++point)
+            destination[(size_t) point] += 20.0 * std::log10 (coefficients.getMagnitude (model.zInverse[(size_t) point]));
+    }
+}
+
+//==============================================================================
+BandCompensator::BandCompensator (const ChainParameters& parametersToUse,
+                                  std::atomic<float>* enabledParameterToUse,
+                                  juce::TimeSliceThread& threadToUse)
+    : parameters (parametersToUse),
+      enabledParameter (enabledParameterToUse),
+      thread (threadToUse)
+{
+    thread.addTimeSliceClient (this);
+}
+
+BandCompensator::~BandCompensator()
+{
+    thread.removeTimeSliceClient (this);
+}
+
+void BandCompensator::prepare (double newSampleRate)
+{
+    RealtimeSafety::checkBlockingCall ("BandCompensator::prepare");
+
+    const juce::ScopedLock sl (solveLock);
+
+    sampleRate = newSampleRate;
+    hasSolution = hasPublished = false;
+
+    if (isEnabled())
+        publish (getChainSettings (parameters));
+}
+
+void BandCompensator::apply (ChainSettings& settings) noexcept
+{
+    auto& result = results.read();
+
+    if (result.isValid && result.mode == settings.bandMode && isEnabled())
+        settings.peakGainInDecibels = result.gains;
+}
+
+ChainSettings BandCompensator::getCompensatedSettings()
+{
+    const juce::ScopedLock sl (solveLock);
+
+    auto requested = getChainSettings (parameters);
+
+    if (! isEnabled() || sampleRate <= 0.0)
+        return requested;
+
+    return solve (requested);
+}
+
+//==============================================================================
+int BandCompensator::useTimeSlice()
+{
+    const juce::ScopedLock sl (solveLock);
+
+    if (sampleRate <= 0.0)
+        return 100;
+
+    if (! isEnabled())
+    {
+        // Withdraw the last solution, so switching back on never applies a stale one
+        if (hasPublished)
+        {
+            results.write ({ {}, BandMode::octave, false });
+            hasPublished = false;
+        }
+
+        return 50;
+    }
+
+    auto requested = getChainSettings (parameters);
+
+    if (! hasPublished || requested != publishedRequest || sampleRate.load() != publishedRate)
+        publish (requested);
+
+    // Short, so a slider being dragged is followed closely
+    return 10;
+}
+
+const ChainSettings& BandCompensator::solve (const ChainSettings& requested)
+{
+    auto rate = sampleRate.load();
+
+    if (! hasSolution || requested != solvedRequest || rate != solvedRate)
+    {
+        solution = requested;
+        solver.compensate (solution, rate);
+        solvedRequest = requested;
+        solvedRate = rate;
+        hasSolution = true;
+    }
+
+    return solution;
+}
+
+void BandCompensator::publish (const ChainSettings& requested)
+{
+    auto& solved = solve (requested);
+
+    results.write ({ solved.peakGainInDecibels, solved.bandMode, true });
+    publishedRequest = requested;
+    publishedRate = solvedRate;
+    hasPublished = true;
+}
@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    BandCompensator.h
+
+    Interaction compensation for the peak bands. Neighbouring bands overlap,
+    so the summed response overshoots the sliders; the solver finds the band
+    gains whose combined response best fits the requested curve in a least
+    squares sense over log frequency.
+
+    The solve runs on the background thread whenever the settings change and
+    is handed to the audio thread through a TripleBuffer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CoefficientEngine.h"
+#include "TripleBuffer.h"
+
+//==============================================================================
+/** Fits band gains to a target curve: the requested gains, interpolated
+    linearly over log frequency between band centres.
+*/
+class CompensationSolver
+{
+public:
+    /** Replaces the peak gains with compensated ones. Allocates whenever the
+        band mode or sample rate differs from the last call.
+    */
+    void compensate (ChainSettings& settings, double sampleRate);
+
+    /** The largest boost or cut the solver may ask a band for. */
+    static constexpr float maximumGainDecibels = 36.0f;
+
+private:
+    //==============================================================================
+    /** Everything that depends only on the band table and sample rate: the
+        fitting points, how the target is interpolated at each, and the
+        regularised pseudo-inverse of the bands' unit responses there.
+    */
+    struct Model
+    {
+        ChainSettings layout;    // only its band mode matters to the peak stages
+        double sampleRate = 0.0;
+        int numBands = 0, numPoints = 0;
+
+        std::vector<std::complex<double>> zInverse;
+        std::vector<int> lowerBand;
+        std::vector<double> upperWeight;
+        std::vector<double> fitWeight;
+        std::vector<double> pseudoInverse;    // numBands rows of numPoints
+    };
+
+    void buildModel (BandMode mode, double sampleRate);
+
+    /** Adds the pseudo-inverse applied to values (one per point) onto gains,
+        returning the largest change to any band. */
+    float project (const std::vector<double>& values, std::array<float, maxPeakBands>& gains) const noexcept;
+
+    /** The combined response in dB of the peak stages at every point. */
+    void evaluateResponse (const std::array<float, maxPeakBands>& gains, std::vector<double>& destination) const noexcept;
+
+    //==============================================================================
+    /** Points between band centres only shape the curve; the centres, where
+        the sliders are, count for most of the fit. */
+    static constexpr int pointsPerBand = 3;
+    static constexpr double betweenCentresWeight = 0.1;
+    static constexpr int maximumIterations = 4;
+    static constexpr float toleranceDecibels = 0.02f;
+
+    Model model;
+    std::vector<double> target, error;
+};
+
+//==============================================================================
+class BandCompensator  : private juce::TimeSliceClient
+{
+public:
+    BandCompensator (const ChainParameters& parametersToUse,
+                     std::atomic<float>* enabledParameterToUse,
+                     juce::TimeSliceThread& threadToUse);
+    ~BandCompensator() override;
+
+    //==============================================================================
+    /** Solves for the current settings straight away, so the first block is
+        already compensated. Call from prepareToPlay.
+    */
+    void prepare (double sampleRate);
+
+    /** Moves the solve to the rate the peaks are designed at, when the
+        oversampling changes. Safe from the audio thread; the background thread
+        re-solves shortly after.
+    */
+    void setSampleRate (double newSampleRate) noexcept    { sampleRate = newSampleRate; }
+
+    bool isEnabled() const noexcept    { return enabledParameter->load() >= 0.5f; }
+
+    /** Audio thread: swaps in the latest solved gains, if compensation is on
+        and a solve for the same band mode has been published. Never blocks.
+    */
+    void apply (ChainSettings& settings) noexcept;
+
+    /** The current parameter settings, compensated if compensation is on.
+        Solves on the spot if they changed; not for the audio thread.
+    */
+    ChainSettings getCompensatedSettings();
+
+private:
+    //==============================================================================
+    struct Result
+    {
+        std::array<float, maxPeakBands> gains;
+        BandMode mode;
+        bool isValid;
+    };
+
+    int useTimeSlice() override;
+
+    /** Solves, or returns the last solution if the request hasn't changed. */
+    const ChainSettings& solve (const ChainSettings& requested);
+    void publish (const ChainSettings& requested);
+
+    //==============================================================================
+    const ChainParameters& parameters;
+    std::atomic<float>* enabledParameter;
+    juce::TimeSliceThread& thread;
+
+    juce::CriticalSection solveLock;
+    CompensationSolver solver;
+    std::atomic<double> sampleRate { 0.0 };
+    double solvedRate = 0.0, publishedRate = 0.0;
+
+    ChainSettings solvedRequest, solution, publishedRequest;
+    bool hasSolution = false, hasPublished = false;
+
+    TripleBuffer<Result> results;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BandCompensator)
+};
@@ -0,0 +1,277 @@
+/*
+  ==============================================================================
+
+    BatchEq.h
+
+    Many EQ tracks processed together, for hosts that would otherwise run
+    dozens of plugin instances side by side. Each track has its own settings
+    and its own CoefficientEngine, ramping exactly as the plugin does, but
+    the filtering is done in groups: the channels of neighbouring tracks
+    share the lanes of one SimdBiquadCascade, whose coefficients and state
+    are stored a register of lanes per stage, so a group runs as one SIMD
+    pass with no per-track dispatch.
+
+    Groups never share data, so they are handed out to worker threads from a
+    shared counter as each thread becomes free, with the thread calling
+    process() joining in.
+
+    This is the plugin's IIR cascade at the base rate with linked channels:
+    oversampling, linear phase, compensation and the channel modes stay in
+    the plugin.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CoefficientEngine.h"
+#include "RealtimeSafety.h"
+#include "SimdBiquadCascade.h"
+
+//==============================================================================
+template <typename SampleType>
+class BatchEq
+{
+public:
+    using StageMask = CoefficientEngine::StageMask;
+
+    static constexpr int numLanes = SimdBiquadCascade<SampleType>::numLanes;
+
+    BatchEq() = default;
+    ~BatchEq()    { stopWorkers(); }
+
+    //==============================================================================
+    /** Allocates numTracks tracks of numChannelsPerTrack channels, all flat, and
+        starts numThreads - 1 worker threads; the thread calling process()
+        makes up the last. Not for the audio thread.
+    */
+    void prepare (double sampleRate, int numTracks, int numChannelsPerTrack, int maximumBlockSize, int numThreads = 1)
+    {
+        RealtimeSafety::checkBlockingCall ("BatchEq::prepare");
+        stopWorkers();
+
+        channelsPerTrack = juce::jmax (1, numChannelsPerTrack);
+        tracks.assign ((size_t) juce::jmax (0, numTracks), Track());
+
+        for (auto& track : tracks)
+        {
+            track.engine.prepare (sampleRate);
+            track.engine.setTargets (ChainSettings());
+        }
+
+        // Whole tracks only, so no track's engine is ever stepped by two threads
+        auto tracksPerGroup = juce::jmax (1, numLanes / channelsPerTrack);
+        numGroups = ((int) tracks.size() + tracksPerGroup - 1) / tracksPerGroup;
+        groups.clear();
+        groups.resize ((size_t) numGroups);
+
+        for (int g = 0; g < numGroups; ++g)
+        {
+            auto& group = groups[(size_t) g];
+            group.firstTrack = g * tracksPerGroup;
+            group.numTracks = juce::jmin (tracksPerGroup, (int) tracks.size() - group.firstTrack);
+            group.lanes.assign ((size_t) (group.numTracks * channelsPerTrack), nullptr);
+            group.cascade.prepare (group.numTracks * channelsPerTrack, ChainPositions::numChainStages, maximumBlockSize);
+            group.bypass.prepare (sampleRate);
+            group.bypass.reset (updateGroup (group));
+        }
+
+        for (int i = 1; i < numThreads; ++i)
+        {
+            workers.push_back (std::make_unique<Worker> (*this));
+            workers.back()->startThread();
+        }
+    }
+
+    /** Clears the filter state of every track. */
+    void reset() noexcept
+    {
+        for (auto& group : groups)
+            group.cascade.reset();
+    }
+
+    int getNumTracks() const noexcept             { return (int) tracks.size(); }
+    int getNumChannelsPerTrack() const noexcept   { return channelsPerTrack; }
+    int getNumThreads() const noexcept            { return (int) workers.size() + 1; }
+
+    //==============================================================================
+    /** Samples between coefficient updates while a track's settings ramp, for
+        every track; 0 turns smoothing off. Call between process() calls.
+    */
+    void setSmoothingInterval (int numSamples) noexcept
+    {
+        for (auto& track : tracks)
+            track.engine.setUpdateInterval (numSamples);
+    }
+
+    /** Gives a track new settings, which it ramps to from the next process().
+        Call between process() calls, from the thread that makes them.
+    */
+    void setSettings (int track, const ChainSettings& settings) noexcept
+    {
+        tracks[(size_t) track].engine.setTargets (settings);
+    }
+
+    /** How long a track keeps ringing for, as CoefficientEngine::getTailSamples(). */
+    double getTailSamples (int track) const noexcept    { return tracks[(size_t) track].engine.getTailSamples(); }
+
+    //==============================================================================
+    /** Filters every track in place. channels holds getNumTracks() *
+        getNumChannelsPerTrack() pointers, each track's channels side by side.
+    */
+    void process (SampleType* const* channels, int numSamples) noexcept
+    {
+        jobChannels = channels;
+        jobSamples = numSamples;
+        groupsDone.store (0, std::memory_order_relaxed);
+        nextGroup.store (0, std::memory_order_release);
+
+        for (auto& worker : workers)
+            worker->wake.signal();
+
+        runGroups();
+
+        // Workers may still be finishing the last groups
+        while (groupsDone.load (std::memory_order_acquire) < numGroups)
+            juce::Thread::yield();
+    }
+
+private:
+    //==============================================================================
+    struct Track
+    {
+        CoefficientEngine engine;
+        StageMask publishedNeutralStages = 0;
+    };
+
+    struct Group
+    {
+        int firstTrack = 0, numTracks = 0;
+        SimdBiquadCascade<SampleType> cascade;
+        StageBypass bypass;
+        std::vector<SampleType*> lanes;
+    };
+
+    class Worker  : public juce::Thread
+    {
+    public:
+        explicit Worker (BatchEq& ownerToUse)  : juce::Thread ("BatchEq worker"), owner (ownerToUse) {}
+
+        void run() override
+        {
+            while (! threadShouldExit())
+                if (wake.wait (100))
+                    owner.runGroups();
+        }
+
+        juce::WaitableEvent wake;
+
+    private:
+        BatchEq& owner;
+    };
+
+    //==============================================================================
+    void stopWorkers()
+    {
+        for (auto& worker : workers)
+        {
+            worker->signalThreadShouldExit();
+            worker->wake.signal();
+            worker->stopThread (1000);
+        }
+
+        workers.clear();
+    }
+
+    /** Takes groups off the shared counter until there are none left. */
+    void runGroups() noexcept
+    {
+        for (auto g = nextGroup.fetch_add (1, std::memory_order_acq_rel); g < numGroups;
+                  g = nextGroup.fetch_add (1, std::memory_order_acq_rel))
+        {
+            processGroup (groups[(size_t) g], jobChannels, jobSamples);
+            groupsDone.fetch_add (1, std::memory_order_release);
+        }
+    }
+
+    /** Steps every track's engine in the group and writes what changed into its
+        lanes. Returns the stages that are neutral on every track, which the
+        group can skip; a stage neutral on only some runs as a straight wire
+        on those, as the plugin does for a second channel of its own.
+    */
+    StageMask updateGroup (Group& group) noexcept
+    {
+        const BiquadCoefficients<double> wire;
+        auto groupNeutralStages = CoefficientEngine::allStages;
+
+        for (int t = 0; t < group.numTracks; ++t)
+        {
+            auto& track = tracks[(size_t) (group.firstTrack + t)];
+            auto changed = track.engine.update();
+            auto neutralStages = track.engine.getNeutralStages();
+
+            changed |= neutralStages ^ track.publishedNeutralStages;
+            track.publishedNeutralStages = neutralStages;
+            groupNeutralStages &= neutralStages;
+
+            for (int stage = 0; changed != 0 && stage < ChainPositions::numChainStages; ++stage)
+            {
+                auto bit = StageMask (1) << stage;
+
+                if ((changed & bit) == 0)
+                    continue;
+
+                auto& coefficients = (neutralStages & bit) != 0 ? wire : track.engine.getStage (stage);
+
+                for (int channel = 0; channel < channelsPerTrack; ++channel)
+                    group.cascade.setStageCoefficients (stage, t * channelsPerTrack + channel, coefficients);
+            }
+        }
+
+        return groupNeutralStages;
+    }
+
+    void processGroup (Group& group, SampleType* const* channels, int numSamples) noexcept
+    {
+        auto firstChannel = group.firstTrack * channelsPerTrack;
+
+        for (size_t lane = 0; lane < group.lanes.size(); ++lane)
+            group.lanes[lane] = channels[(size_t) firstChannel + lane];
+
+        for (int start = 0; start < numSamples;)
+        {
+            group.bypass.setNeutralStages (updateGroup (group));
+
+            // The tracks all step on the same grid, so this is where the next one is due
+            auto subBlockSize = numSamples - start;
+
+            for (int t = 0; t < group.numTracks; ++t)
+                subBlockSize = tracks[(size_t) (group.firstTrack + t)].engine.getSamplesUntilUpdate (subBlockSize);
+
+            juce::dsp::AudioBlock<SampleType> block (group.lanes.data(), group.lanes.size(), (size_t) start, (size_t) subBlockSize);
+            group.cascade.process (block, group.bypass);
+
+            if (auto fadedOut = group.bypass.advance (subBlockSize))
+                for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+                    if ((fadedOut & (StageMask (1) << stage)) != 0)
+                        group.cascade.resetStage (stage);
+
+            for (int t = 0; t < group.numTracks; ++t)
+                tracks[(size_t) (group.firstTrack + t)].engine.advance (subBlockSize);
+
+            start += subBlockSize;
+        }
+    }
+
+    //==============================================================================
+    std::vector<Track> tracks;
+    std::vector<Group> groups;
+    int channelsPerTrack = 1, numGroups = 0;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<int> nextGroup { 0 }, groupsDone { 0 };
+    SampleType* const* jobChannels = nullptr;
+    int jobSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BatchEq)
+};
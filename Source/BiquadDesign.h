@@ -0,0 +1,176 @@
+/*
+  ==============================================================================
+
+    BiquadDesign.h
+
+    Allocation-free second-order filter design. Uses the same formulae as
+    juce::dsp::IIR::Coefficients::makePeakFilter/makeHighPass/makeLowPass, but
+    writes into plain structs so it can run on the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Normalised (a0 == 1) biquad coefficients, in the same order that
+    juce::dsp::IIR::Coefficients stores them: b0, b1, b2, a1, a2.
+*/
+template <typename NumericType>
+struct BiquadCoefficients
+{
+    NumericType b0 { 1 }, b1 { 0 }, b2 { 0 }, a1 { 0 }, a2 { 0 };
+
+    template <typename OtherType>
+    BiquadCoefficients<OtherType> cast() const noexcept
+    {
+        return { static_cast<OtherType> (b0), static_cast<OtherType> (b1), static_cast<OtherType> (b2),
+                 static_cast<OtherType> (a1), static_cast<OtherType> (a2) };
+    }
+
+    /** Copies into the raw storage of an existing second-order juce::dsp::IIR::Coefficients. */
+    template <typename OtherType>
+    void copyTo (OtherType* raw) const noexcept
+    {
+        raw[0] = static_cast<OtherType> (b0);
+        raw[1] = static_cast<OtherType> (b1);
+        raw[2] = static_cast<OtherType> (b2);
+        raw[3] = static_cast<OtherType> (a1);
+        raw[4] = static_cast<OtherType> (a2);
+    }
+
+    /** Magnitude of the frequency response at a frequency in Hz. */
+    double getMagnitude (double frequency, double sampleRate) const noexcept
+    {
+        auto omega = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+        return getMagnitude (std::polar (1.0, -omega));
+    }
+
+    /** Magnitude of the frequency response at z^-1 = e^-jw. Saves the trig
+        when the same frequencies are evaluated again and again.
+    */
+    double getMagnitude (std::complex<double> z1) const noexcept
+    {
+        return std::abs (getResponse (z1));
+    }
+
+    /** Complex frequency response at z^-1 = z1. */
+    std::complex<double> getResponse (std::complex<double> z1) const noexcept
+    {
+        auto z2 = z1 * z1;
+
+        auto numerator   = (double) b0 + (double) b1 * z1 + (double) b2 * z2;
+        auto denominator = 1.0 + (double) a1 * z1 + (double) a2 * z2;
+
+        return numerator / denominator;
+    }
+
+    /** The largest magnitude of the two poles, which sets how slowly the
+        impulse response dies away. 1 or more means the section is unstable.
+    */
+    double getPoleRadius() const noexcept
+    {
+        auto discriminant = (double) a1 * a1 - 4.0 * a2;
+
+        if (discriminant < 0.0)
+            return std::sqrt ((double) a2);    // a complex pair, both at this radius
+
+        auto root = std::sqrt (discriminant);
+        return 0.5 * juce::jmax (std::abs (-a1 + root), std::abs (-a1 - root));
+    }
+
+    /** Samples until the impulse response's envelope has fallen by
+        attenuationDecibels, from the pole radius. Infinite if unstable.
+    */
+    double getDecayLength (double attenuationDecibels) const noexcept
+    {
+        auto radius = getPoleRadius();
+
+        if (radius >= 1.0)
+            return std::numeric_limits<double>::infinity();
+
+        // Two samples for the feed-forward part, which rings for no time at all
+        if (radius <= 0.0)
+            return 2.0;
+
+        return 2.0 + attenuationDecibels / (-20.0 * std::log10 (radius));
+    }
+
+    /** Linear interpolation between two designs, coefficient by coefficient.
+        Stable whenever both ends are: a1 and a2 stay inside the stability
+        triangle, which is convex.
+    */
+    static BiquadCoefficients interpolate (const BiquadCoefficients& from, const BiquadCoefficients& to, NumericType amount) noexcept
+    {
+        return { from.b0 + (to.b0 - from.b0) * amount, from.b1 + (to.b1 - from.b1) * amount, from.b2 + (to.b2 - from.b2) * amount,
+                 from.a1 + (to.a1 - from.a1) * amount, from.a2 + (to.a2 - from.a2) * amount };
+    }
+
+    bool operator== (const BiquadCoefficients& other) const noexcept
+    {
+        return b0 == other.b0 && b1 == other.b1 && b2 == other.b2 && a1 == other.a1 && a2 == other.a2;
+    }
+
+    bool operator!= (const BiquadCoefficients& other) const noexcept    { return ! operator== (other); }
+};
+
+//==============================================================================
+namespace BiquadDesign
+{
+    /** Keeps the design frequency inside (0, Nyquist), where the bilinear transform is defined. */
+    inline double clampFrequency (double frequency, double sampleRate) noexcept
+    {
+        return juce::jlimit (2.0, sampleRate * 0.499, frequency);
+    }
+
+    template <typename NumericType>
+    BiquadCoefficients<NumericType> makeNormalised (double b0, double b1, double b2,
+                                                    double a0, double a1, double a2) noexcept
+    {
+        auto a0Inv = 1.0 / a0;
+
+        return { static_cast<NumericType> (b0 * a0Inv), static_cast<NumericType> (b1 * a0Inv),
+                 static_cast<NumericType> (b2 * a0Inv), static_cast<NumericType> (a1 * a0Inv),
+                 static_cast<NumericType> (a2 * a0Inv) };
+    }
+
+    template <typename NumericType>
+    BiquadCoefficients<NumericType> makePeak (double sampleRate, double frequency, double Q, double gainFactor) noexcept
+    {
+        auto A = std::sqrt (juce::jmax (0.0, gainFactor));
+        auto omega = juce::MathConstants<double>::twoPi * clampFrequency (frequency, sampleRate) / sampleRate;
+        auto alpha = std::sin (omega) / (Q * 2.0);
+        auto c2 = -2.0 * std::cos (omega);
+        auto alphaTimesA = alpha * A;
+        auto alphaOverA = alpha / A;
+
+        return makeNormalised<NumericType> (1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                                            1.0 + alphaOverA,  c2, 1.0 - alphaOverA);
+    }
+
+    template <typename NumericType>
+    BiquadCoefficients<NumericType> makeHighPass (double sampleRate, double frequency, double Q) noexcept
+    {
+        auto n = std::tan (juce::MathConstants<double>::pi * clampFrequency (frequency, sampleRate) / sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1.0 / Q;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return makeNormalised<NumericType> (c1, c1 * -2.0, c1,
+                                            1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    template <typename NumericType>
+    BiquadCoefficients<NumericType> makeLowPass (double sampleRate, double frequency, double Q) noexcept
+    {
+        auto n = 1.0 / std::tan (juce::MathConstants<double>::pi * clampFrequency (frequency, sampleRate) / sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1.0 / Q;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return makeNormalised<NumericType> (c1, c1 * 2.0, c1,
+                                            1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+    }
+}
@@ -0,0 +1,256 @@
+/*
+  ==============================================================================
+
+    CoefficientEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientEngine.h"
+
+//==============================================================================
+void CoefficientEngine::prepare (double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    needsFullUpdate = true;
+    samplesIntoInterval = 0;
+
+    // Morph sets are designed for one rate; the caller hands over new ones
+    morphing = false;
+
+    for (auto& smoother : smoothers)
+    {
+        smoother.reset (sampleRate, smoothingTimeSeconds);
+        smoother.setCurrentAndTargetValue (smoother.getTargetValue());
+    }
+
+    morphPosition.reset (sampleRate, smoothingTimeSeconds);
+    morphPosition.setCurrentAndTargetValue (morphPosition.getTargetValue());
+}
+
+void CoefficientEngine::setUpdateInterval (int numSamples) noexcept
+{
+    if (numSamples == updateInterval)
+        return;
+
+    updateInterval = numSamples;
+    samplesIntoInterval = 0;
+
+    if (updateInterval <= 0)
+    {
+        for (auto& smoother : smoothers)
+            smoother.setCurrentAndTargetValue (smoother.getTargetValue());
+
+        morphPosition.setCurrentAndTargetValue (morphPosition.getTargetValue());
+    }
+}
+
+void CoefficientEngine::setTargets (const ChainSettings& settings) noexcept
+{
+    if (morphing)
+    {
+        // The stages are wherever the morph left them, so don't ramp from the
+        // values they had before it
+        morphing = false;
+        needsFullUpdate = true;
+    }
+
+    if (! settings.hasSameLayout (layout))
+    {
+        layout = settings;
+        needsFullUpdate = true;
+    }
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+    {
+        auto value = settings.getStageValue (stage);
+
+        if (value == targets[(size_t) stage] && ! needsFullUpdate)
+            continue;
+
+        targets[(size_t) stage] = value;
+        auto& smoother = smoothers[(size_t) stage];
+
+        if (updateInterval > 0 && ! needsFullUpdate)
+            smoother.setTargetValue (toSmoothingDomain (stage, value));
+        else
+            smoother.setCurrentAndTargetValue (toSmoothingDomain (stage, value));
+    }
+}
+
+CoefficientEngine::StageMask CoefficientEngine::update() noexcept
+{
+    // Ramps only step on the grid, so the result doesn't depend on where the
+    // host's blocks happen to start
+    auto isOnGrid = (samplesIntoInterval == 0);
+
+    if (morphing)
+        return updateMorph (isOnGrid);
+
+    StageMask changed = 0;
+    isSmoothing = false;
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+    {
+        auto& smoother = smoothers[(size_t) stage];
+        auto value = (isOnGrid && smoother.isSmoothing()) ? smoother.skip (updateInterval)
+                                                          : smoother.getCurrentValue();
+        isSmoothing = isSmoothing || smoother.isSmoothing();
+
+        if (! smoother.isSmoothing() && ChainSettings::isStageValueNeutral (stage, targets[(size_t) stage]))
+            neutralStages |= (StageMask (1) << stage);
+        else
+            neutralStages &= ~(StageMask (1) << stage);
+
+        if (! needsFullUpdate && value == lastValues[(size_t) stage])
+            continue;
+
+        lastValues[(size_t) stage] = value;
+        stages[(size_t) stage] = designStage (sampleRate, layout, stage, fromSmoothingDomain (stage, value));
+        decaySamples[(size_t) stage] = stages[(size_t) stage].getDecayLength (tailDecibels);
+        changed |= (StageMask (1) << stage);
+    }
+
+    needsFullUpdate = false;
+    return changed;
+}
+
+void CoefficientEngine::setMorphTargets (const CoefficientSet& from, const CoefficientSet& to,
+                                         juce::uint32 version, float position) noexcept
+{
+    if (! morphing || version != morphVersion)
+    {
+        // Copied only when they change, so the sets outlive whatever handed them over
+        morphFrom = from;
+        morphTo = to;
+        morphVersion = version;
+        needsFullUpdate = true;
+    }
+
+    if (updateInterval > 0 && morphing)
+        morphPosition.setTargetValue (position);
+    else
+        morphPosition.setCurrentAndTargetValue (position);
+
+    morphing = true;
+}
+
+CoefficientEngine::StageMask CoefficientEngine::updateMorph (bool isOnGrid) noexcept
+{
+    auto position = (isOnGrid && morphPosition.isSmoothing()) ? morphPosition.skip (updateInterval)
+                                                              : morphPosition.getCurrentValue();
+    isSmoothing = morphPosition.isSmoothing();
+
+    // In between, a stage is only neutral if it is at both ends, where both
+    // designs are the same straight wire
+    if (isSmoothing || (position > 0.0f && position < 1.0f))
+        neutralStages = morphFrom.neutralStages & morphTo.neutralStages;
+    else
+        neutralStages = position <= 0.0f ? morphFrom.neutralStages : morphTo.neutralStages;
+
+    if (! needsFullUpdate && position == lastMorphPosition)
+        return 0;
+
+    StageMask changed = 0;
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+    {
+        auto& from = morphFrom.stages[(size_t) stage];
+        auto& to = morphTo.stages[(size_t) stage];
+
+        // Stages the two sets agree on don't move with the position
+        if (! needsFullUpdate && from == to)
+            continue;
+
+        stages[(size_t) stage] = BiquadCoefficients<double>::interpolate (from, to, (double) position);
+        decaySamples[(size_t) stage] = stages[(size_t) stage].getDecayLength (tailDecibels);
+        changed |= (StageMask (1) << stage);
+    }
+
+    lastMorphPosition = position;
+    needsFullUpdate = false;
+    return changed;
+}
+
+CoefficientEngine::CoefficientSet CoefficientEngine::designAll (double sampleRate, const ChainSettings& settings) noexcept
+{
+    CoefficientSet result;
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+    {
+        result.stages[(size_t) stage] = designStage (sampleRate, settings, stage, settings.getStageValue (stage));
+
+        if (settings.isStageNeutral (stage))
+            result.neutralStages |= (StageMask (1) << stage);
+    }
+
+    return result;
+}
+
+double CoefficientEngine::getTailSamples() const noexcept
+{
+    auto total = 0.0;
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+        if ((neutralStages & (StageMask (1) << stage)) == 0)
+            total += decaySamples[(size_t) stage];
+
+    return total;
+}
+
+bool CoefficientEngine::isRamping() const noexcept
+{
+    if (morphing)
+        return morphPosition.isSmoothing();
+
+    return std::any_of (smoothers.begin(), smoothers.end(), [] (const auto& smoother) { return smoother.isSmoothing(); });
+}
+
+int CoefficientEngine::getSamplesUntilUpdate (int numSamples) const noexcept
+{
+    if (! isSmoothing)
+        return numSamples;
+
+    return juce::jmin (numSamples, updateInterval - samplesIntoInterval);
+}
+
+void CoefficientEngine::advance (int numSamples) noexcept
+{
+    if (updateInterval > 0)
+        samplesIntoInterval = (samplesIntoInterval + numSamples) % updateInterval;
+}
+
+float CoefficientEngine::toSmoothingDomain (int stage, float value) noexcept
+{
+    if (isPeakStage (stage))
+        return value;
+
+    return std::log (juce::jmax (1.0f, value));
+}
+
+double CoefficientEngine::fromSmoothingDomain (int stage, float smoothedValue) noexcept
+{
+    if (isPeakStage (stage))
+        return smoothedValue;
+
+    return std::exp ((double) smoothedValue);
+}
+
+BiquadCoefficients<double> CoefficientEngine::designStage (double sampleRate, const ChainSettings& layout, int stage, double value) noexcept
+{
+    if (isLowCutStage (stage))
+        return BiquadDesign::makeHighPass<double> (sampleRate, value, layout.getCutQuality (stage));
+
+    if (isHighCutStage (stage))
+        return BiquadDesign::makeLowPass<double> (sampleRate, value, layout.getCutQuality (stage));
+
+    auto table = getBandTable (layout.bandMode);
+    auto band = getPeakBand (stage);
+
+    // Stages past the end of the table only ever hold a neutral gain
+    if (band >= table.numBands)
+        return {};
+
+    return BiquadDesign::makePeak<double> (sampleRate, table.bands[band].frequency, table.bands[band].quality,
+                                           juce::Decibels::decibelsToGain (value));
+}
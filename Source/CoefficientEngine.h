@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    CoefficientEngine.h
+
+    Change-driven coefficient design for the EQ cascade. Each stage ramps
+    towards its target setting and is redesigned on a fixed grid of samples,
+    only while it is actually moving, into storage owned by the engine, so it
+    is safe to drive from processBlock.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BiquadDesign.h"
+#include "EqBands.h"
+
+//==============================================================================
+class CoefficientEngine
+{
+public:
+    /** One bit per ChainPositions entry. */
+    using StageMask = juce::uint64;
+
+    static constexpr StageMask allStages = (StageMask (1) << ChainPositions::numChainStages) - 1;
+
+    /** How far the cascade's impulse response has to fall before it counts as over. */
+    static constexpr double tailDecibels = 100.0;
+
+    /** Length of the ramp when a stage's setting changes. */
+    static constexpr double smoothingTimeSeconds = 0.05;
+
+    /** Every stage of the cascade designed for one setting, for morphing between. */
+    struct CoefficientSet
+    {
+        std::array<BiquadCoefficients<double>, ChainPositions::numChainStages> stages;
+        StageMask neutralStages = 0;
+    };
+
+    /** Designs every stage of the settings at once. */
+    static CoefficientSet designAll (double sampleRate, const ChainSettings& settings) noexcept;
+
+    /** Sets the design sample rate; the next update() redesigns every stage and
+        any ramps in progress jump to their targets.
+    */
+    void prepare (double newSampleRate) noexcept;
+
+    /** Sets how many samples pass between coefficient updates while a stage is
+        ramping. 0 turns smoothing off, so new settings land in one step.
+    */
+    void setUpdateInterval (int numSamples) noexcept;
+    int getUpdateInterval() const noexcept    { return updateInterval; }
+
+    /** Gives each stage a new target, usually once per block. A change of band
+        mode, cut slope or cut alignment retunes stages whose value may not have
+        moved at all, so it redesigns all stages at once, without ramping.
+    */
+    void setTargets (const ChainSettings& settings) noexcept;
+
+    /** Morphs between two coefficient sets instead of following settings: each
+        stage is interpolated between its two designs, coefficient by
+        coefficient, so moving the position never designs a filter. Only the
+        position ramps; a new pair of sets, marked by another version, lands in
+        one step. setTargets() goes back to following settings.
+    */
+    void setMorphTargets (const CoefficientSet& from, const CoefficientSet& to, juce::uint32 version, float position) noexcept;
+    bool isMorphing() const noexcept    { return morphing; }
+
+    /** Redesigns the stages whose value moved, stepping any ramp that is due at
+        the current position, and returns the mask of stages that were touched.
+        Never allocates.
+    */
+    StageMask update() noexcept;
+
+    /** True while any stage is still on its way to its target. */
+    bool isRamping() const noexcept;
+
+    /** How many of the next numSamples can run before update() has to be called again. */
+    int getSamplesUntilUpdate (int numSamples) const noexcept;
+
+    /** Moves the position on the update grid forward. */
+    void advance (int numSamples) noexcept;
+
+    const BiquadCoefficients<double>& getStage (int stage) const noexcept    { return stages[(size_t) stage]; }
+
+    /** How many samples the current coefficients keep ringing for, down to
+        tailDecibels: the sum of every non-neutral stage's decay, which is
+        never shorter than the cascade's own.
+    */
+    double getTailSamples() const noexcept;
+
+    /** Stages that are currently acoustically neutral, see ChainSettings::isStageNeutral(). */
+    StageMask getNeutralStages() const noexcept                               { return neutralStages; }
+
+    /** Designs one stage straight from its setting, a cut frequency in Hz or a
+        peak gain in dB. The peak's frequency and Q come from the band table and
+        a cut section's Q from its slope and alignment, all taken from layout;
+        its stage values are ignored. Used by anything that needs the cascade's
+        response off the audio thread.
+    */
+    static BiquadCoefficients<double> designStage (double sampleRate, const ChainSettings& layout, int stage, double value) noexcept;
+
+private:
+    /** Stages ramp linearly in dB for peaks and in log frequency for the cuts. */
+    static float toSmoothingDomain (int stage, float value) noexcept;
+    static double fromSmoothingDomain (int stage, float smoothedValue) noexcept;
+
+    StageMask updateMorph (bool isOnGrid) noexcept;
+
+    double sampleRate = 44100.0;
+    int updateInterval = 0, samplesIntoInterval = 0;
+    bool needsFullUpdate = true, isSmoothing = false, morphing = false;
+    StageMask neutralStages = 0;
+    ChainSettings layout;
+
+    std::array<float, ChainPositions::numChainStages> targets {}, lastValues {};
+    std::array<juce::SmoothedValue<float>, ChainPositions::numChainStages> smoothers;
+    std::array<BiquadCoefficients<double>, ChainPositions::numChainStages> stages;
+    std::array<double, ChainPositions::numChainStages> decaySamples {};
+
+    CoefficientSet morphFrom, morphTo;
+    juce::uint32 morphVersion = 0;
+    juce::SmoothedValue<float> morphPosition;
+    float lastMorphPosition = 0.0f;
+};
@@ -0,0 +1,286 @@
+/*
+  ==============================================================================
+
+    EqBands.h
+
+    The band tables, the stages of the EQ cascade and the settings that
+    drive them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Which band table drives the peak stages. */
+enum class BandMode
+{
+    octave,         // 10 bands, an octave apart
+    thirdOctave     // 31 bands, a third of an octave apart
+};
+
+struct PeakBand
+{
+    const char* parameterID;
+    const char* name;
+    double frequency;
+    double quality;
+};
+
+/** Q of 0.707 keeps neighbouring octave bands overlapping smoothly. */
+constexpr PeakBand octaveBands[] =
+{
+    { "peak31",  "31 Hz",  31.0,    0.707 },
+    { "peak62",  "62 Hz",  62.0,    0.707 },
+    { "peak125", "125 Hz", 125.0,   0.707 },
+    { "peak250", "250 Hz", 250.0,   0.707 },
+    { "peak500", "500 Hz", 500.0,   0.707 },
+    { "peak1k",  "1 kHz",  1000.0,  0.707 },
+    { "peak2k",  "2 kHz",  2000.0,  0.707 },
+    { "peak4k",  "4 kHz",  4000.0,  0.707 },
+    { "peak8k",  "8 kHz",  8000.0,  0.707 },
+    { "peak16k", "16 kHz", 16000.0, 0.707 }
+};
+
+/** ISO 266 third-octave centres. Q of 4.32 is a third of an octave between
+    the half-gain points.
+*/
+constexpr PeakBand thirdOctaveBands[] =
+{
+    { "third20",    "1/3 oct 20 Hz",    20.0,    4.32 },
+    { "third25",    "1/3 oct 25 Hz",    25.0,    4.32 },
+    { "third31",    "1/3 oct 31.5 Hz",  31.5,    4.32 },
+    { "third40",    "1/3 oct 40 Hz",    40.0,    4.32 },
+    { "third50",    "1/3 oct 50 Hz",    50.0,    4.32 },
+    { "third63",    "1/3 oct 63 Hz",    63.0,    4.32 },
+    { "third80",    "1/3 oct 80 Hz",    80.0,    4.32 },
+    { "third100",   "1/3 oct 100 Hz",   100.0,   4.32 },
+    { "third125",   "1/3 oct 125 Hz",   125.0,   4.32 },
+    { "third160",   "1/3 oct 160 Hz",   160.0,   4.32 },
+    { "third200",   "1/3 oct 200 Hz",   200.0,   4.32 },
+    { "third250",   "1/3 oct 250 Hz",   250.0,   4.32 },
+    { "third315",   "1/3 oct 315 Hz",   315.0,   4.32 },
+    { "third400",   "1/3 oct 400 Hz",   400.0,   4.32 },
+    { "third500",   "1/3 oct 500 Hz",   500.0,   4.32 },
+    { "third630",   "1/3 oct 630 Hz",   630.0,   4.32 },
+    { "third800",   "1/3 oct 800 Hz",   800.0,   4.32 },
+    { "third1k",    "1/3 oct 1 kHz",    1000.0,  4.32 },
+    { "third1k25",  "1/3 oct 1.25 kHz", 1250.0,  4.32 },
+    { "third1k6",   "1/3 oct 1.6 kHz",  1600.0,  4.32 },
+    { "third2k",    "1/3 oct 2 kHz",    2000.0,  4.32 },
+    { "third2k5",   "1/3 oct 2.5 kHz",  2500.0,  4.32 },
+    { "third3k15",  "1/3 oct 3.15 kHz", 3150.0,  4.32 },
+    { "third4k",    "1/3 oct 4 kHz",    4000.0,  4.32 },
+    { "third5k",    "1/3 oct 5 kHz",    5000.0,  4.32 },
+    { "third6k3",   "1/3 oct 6.3 kHz",  6300.0,  4.32 },
+    { "third8k",    "1/3 oct 8 kHz",    8000.0,  4.32 },
+    { "third10k",   "1/3 oct 10 kHz",   10000.0, 4.32 },
+    { "third12k5",  "1/3 oct 12.5 kHz", 12500.0, 4.32 },
+    { "third16k",   "1/3 oct 16 kHz",   16000.0, 4.32 },
+    { "third20k",   "1/3 oct 20 kHz",   20000.0, 4.32 }
+};
+
+constexpr int numOctaveBands      = (int) std::size (octaveBands);
+constexpr int numThirdOctaveBands = (int) std::size (thirdOctaveBands);
+constexpr int maxPeakBands        = juce::jmax (numOctaveBands, numThirdOctaveBands);
+
+/** The bands of one mode. */
+struct BandTable
+{
+    const PeakBand* bands;
+    int numBands;
+
+    constexpr const PeakBand* begin() const noexcept    { return bands; }
+    constexpr const PeakBand* end() const noexcept      { return bands + numBands; }
+};
+
+constexpr BandTable getBandTable (BandMode mode) noexcept
+{
+    return mode == BandMode::thirdOctave ? BandTable { thirdOctaveBands, numThirdOctaveBands }
+                                         : BandTable { octaveBands, numOctaveBands };
+}
+
+//==============================================================================
+/** How a cut filter's sections are tuned. The original alignment repeats the
+    plugin's first single Q 1 section, so older sessions sound as they did.
+*/
+enum class CutType
+{
+    original,
+    butterworth,
+    linkwitzRiley
+};
+
+/** Each cut is up to four second-order sections, 12 dB/oct apiece. */
+constexpr int maxCutSections = 4;
+
+/** Q of each section for every slope. Linkwitz-Riley is the Butterworth of half
+    the order, squared; the squared first-order pole of the odd orders is a
+    single section with Q 0.5.
+*/
+constexpr double butterworthQualities[maxCutSections][maxCutSections] =
+{
+    { 0.70710678 },
+    { 0.54119610, 1.30656296 },
+    { 0.51763809, 0.70710678, 1.93185165 },
+    { 0.50979558, 0.60134489, 0.89997622, 2.56291545 }
+};
+
+constexpr double linkwitzRileyQualities[maxCutSections][maxCutSections] =
+{
+    { 0.5 },
+    { 0.70710678, 0.70710678 },
+    { 1.0, 1.0, 0.5 },
+    { 0.54119610, 1.30656296, 0.54119610, 1.30656296 }
+};
+
+constexpr double getCutQuality (CutType type, int numSections, int section) noexcept
+{
+    return type == CutType::butterworth   ? butterworthQualities[numSections - 1][section]
+         : type == CutType::linkwitzRiley ? linkwitzRileyQualities[numSections - 1][section]
+                                          : 1.0;
+}
+
+//==============================================================================
+/** The cascade has room for the widest table and the steepest cuts: the low
+    cut sections, a peak stage per band, then the high cut sections. Peak
+    stages past the end of the active table and cut sections past the chosen
+    slope stay neutral, and are skipped.
+*/
+enum ChainPositions
+{
+    Lowcut,
+    firstPeak = Lowcut + maxCutSections,
+    HiCut = firstPeak + maxPeakBands,
+    numChainStages = HiCut + maxCutSections
+};
+
+/** The cut filters are treated as switched off at the ends of their range. */
+constexpr float minimumCutFrequency = 20.f;
+constexpr float maximumCutFrequency = 20000.f;
+
+constexpr int getPeakStage (int band) noexcept       { return ChainPositions::firstPeak + band; }
+constexpr int getPeakBand (int stage) noexcept       { return stage - ChainPositions::firstPeak; }
+constexpr bool isPeakStage (int stage) noexcept      { return stage >= ChainPositions::firstPeak && stage < ChainPositions::HiCut; }
+constexpr bool isLowCutStage (int stage) noexcept    { return stage < ChainPositions::firstPeak; }
+constexpr bool isHighCutStage (int stage) noexcept   { return stage >= ChainPositions::HiCut; }
+
+/** Which section of its cut filter a cut stage is. */
+constexpr int getCutSection (int stage) noexcept     { return isLowCutStage (stage) ? stage - ChainPositions::Lowcut
+                                                                                    : stage - ChainPositions::HiCut; }
+
+//==============================================================================
+struct ChainSettings
+{
+    /** Gains for the bands of bandMode's table; any entries past its end stay 0. */
+    std::array<float, maxPeakBands> peakGainInDecibels {};
+
+    float lowCutFreq{ 0 }, hiCutFreq{ 0 };
+    BandMode bandMode = BandMode::octave;
+
+    /** Slopes as a number of sections, 1 to maxCutSections. */
+    int lowCutSections = 1, hiCutSections = 1;
+    CutType lowCutType = CutType::original, hiCutType = CutType::original;
+
+    /** The value that drives a stage: a cut frequency in Hz or a peak gain in dB.
+        Cut sections past the chosen slope sit at the neutral end of the range.
+    */
+    float getStageValue (int stage) const noexcept
+    {
+        if (isLowCutStage (stage))   return getCutSection (stage) < lowCutSections ? lowCutFreq : minimumCutFrequency;
+        if (isHighCutStage (stage))  return getCutSection (stage) < hiCutSections ? hiCutFreq : maximumCutFrequency;
+
+        return peakGainInDecibels[(size_t) getPeakBand (stage)];
+    }
+
+    /** Q of a cut stage's section, for the chosen slope and alignment. */
+    double getCutQuality (int stage) const noexcept
+    {
+        return isLowCutStage (stage) ? ::getCutQuality (lowCutType, lowCutSections, getCutSection (stage))
+                                     : ::getCutQuality (hiCutType, hiCutSections, getCutSection (stage));
+    }
+
+    bool isStageNeutral (int stage) const noexcept    { return isStageValueNeutral (stage, getStageValue (stage)); }
+
+    /** True if every stage would be designed the same way from the same value:
+        the same band table and the same cut slopes and alignments.
+    */
+    bool hasSameLayout (const ChainSettings& other) const noexcept
+    {
+        return bandMode == other.bandMode
+            && lowCutSections == other.lowCutSections && hiCutSections == other.hiCutSections
+            && lowCutType == other.lowCutType && hiCutType == other.hiCutType;
+    }
+
+    bool operator== (const ChainSettings& other) const noexcept
+    {
+        return peakGainInDecibels == other.peakGainInDecibels && hasSameLayout (other)
+            && lowCutFreq == other.lowCutFreq && hiCutFreq == other.hiCutFreq;
+    }
+
+    bool operator!= (const ChainSettings& other) const noexcept    { return ! operator== (other); }
+
+    /** A point between two settings: peak gains in dB and cut frequencies in
+        log frequency, as the stages ramp. Settings with different layouts
+        can't be blended like that, so those switch over halfway.
+    */
+    static ChainSettings interpolate (const ChainSettings& from, const ChainSettings& to, float position) noexcept
+    {
+        if (! from.hasSameLayout (to))
+            return position < 0.5f ? from : to;
+
+        auto result = from;
+
+        for (size_t band = 0; band < result.peakGainInDecibels.size(); ++band)
+            result.peakGainInDecibels[band] += (to.peakGainInDecibels[band] - from.peakGainInDecibels[band]) * position;
+
+        auto blendFrequency = [position] (float a, float b) { return a * std::pow (b / a, position); };
+        result.lowCutFreq = blendFrequency (from.lowCutFreq, to.lowCutFreq);
+        result.hiCutFreq = blendFrequency (from.hiCutFreq, to.hiCutFreq);
+
+        return result;
+    }
+
+    /** True if a stage driven by this value leaves the signal untouched and can be skipped. */
+    static bool isStageValueNeutral (int stage, float value) noexcept
+    {
+        if (isLowCutStage (stage))   return value <= minimumCutFrequency;
+        if (isHighCutStage (stage))  return value >= maximumCutFrequency;
+
+        return value == 0.0f;
+    }
+};
+
+//==============================================================================
+/** The parameter atomics behind ChainSettings, resolved once so the audio
+    thread never has to look parameters up by ID.
+*/
+struct ChainParameters
+{
+    /** The IDs are the first channel's with idSuffix appended; the band mode is
+        shared by both channels, so it never takes the suffix.
+    */
+    explicit ChainParameters (juce::AudioProcessorValueTreeState& apvts, const juce::String& idSuffix = {});
+
+    /** Resolves each ID through a function instead, for settings kept
+        somewhere other than the parameters themselves. */
+    using Lookup = std::function<std::atomic<float>* (const juce::String& parameterID)>;
+    explicit ChainParameters (const Lookup& lookup, const juce::String& idSuffix = {});
+
+    /** Appended to the IDs of the second channel's parameters. */
+    static constexpr const char* secondChannelSuffix = "_2";
+
+    std::atomic<float>* lowCutFreq = nullptr;
+    std::atomic<float>* hiCutFreq = nullptr;
+    std::atomic<float>* bandMode = nullptr;
+    std::atomic<float>* lowCutSlope = nullptr;
+    std::atomic<float>* hiCutSlope = nullptr;
+    std::atomic<float>* lowCutType = nullptr;
+    std::atomic<float>* hiCutType = nullptr;
+    std::array<std::atomic<float>*, numOctaveBands> octaveGains {};
+    std::array<std::atomic<float>*, numThirdOctaveBands> thirdOctaveGains {};
+};
+
+ChainSettings getChainSettings(const ChainParameters& parameters);
@@ -0,0 +1,208 @@
+/*
+  ==============================================================================
+
+    EqCascade.h
+
+    The IIR cascade at one sample precision: a reference chain of
+    juce::dsp::IIR::Filters per channel, the coefficient objects those
+    chains share, and the SIMD kernel that can run all channels at once
+    instead.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "SimdBiquadCascade.h"
+#include "EqBands.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+/** One filter per ChainPositions entry, so its length follows the band tables. */
+template <typename SampleType>
+using MonoChain = std::array<juce::dsp::IIR::Filter<SampleType>, ChainPositions::numChainStages>;
+
+static_assert (ChainPositions::numChainStages <= StageBypass::maxStages, "Too many stages for a StageMask");
+
+//==============================================================================
+template <typename SampleType>
+class EqCascade
+{
+public:
+    using Filter = juce::dsp::IIR::Filter<SampleType>;
+    using StageMask = StageBypass::StageMask;
+
+    EqCascade()
+    {
+        // The chains share one preallocated second-order Coefficients object per
+        // stage, which setStageCoefficients() rewrites in place.
+        for (auto* set : { &coefficients, &secondChannelCoefficients })
+            for (auto& c : *set)
+                c = new juce::dsp::IIR::Coefficients<SampleType> (1, 0, 0, 1, 0, 0);
+    }
+
+    //==============================================================================
+    /** Allocates a chain per channel and the SIMD state. Not for the audio thread. */
+    void prepare (double sampleRate, int numChannels, int maximumBlockSize)
+    {
+        RealtimeSafety::checkBlockingCall ("EqCascade::prepare");
+
+        juce::dsp::ProcessSpec spec;
+        spec.maximumBlockSize = (juce::uint32) maximumBlockSize;
+        spec.numChannels = 1;
+        spec.sampleRate = sampleRate;
+
+        chains.resize ((size_t) numChannels);
+
+        for (size_t channel = 0; channel < chains.size(); ++channel)
+        {
+            // The second channel has coefficients of its own, for the independent channel modes
+            auto& source = channel == 1 ? secondChannelCoefficients : coefficients;
+
+            forEachStage (chains[channel], [&source, &spec] (Filter& filter, int stage)
+            {
+                filter.coefficients = source[(size_t) stage];
+                filter.prepare (spec);
+            });
+        }
+
+        simdCascade.prepare (numChannels, ChainPositions::numChainStages, maximumBlockSize);
+    }
+
+    void reset() noexcept
+    {
+        for (auto& chain : chains)
+            for (auto& filter : chain)
+                filter.reset();
+
+        simdCascade.reset();
+    }
+
+    /** Clears the filter state of the given stages in both engines. */
+    void resetStages (StageMask stages) noexcept
+    {
+        auto resetIfSelected = [stages] (Filter& filter, int stage)
+        {
+            if ((stages & (StageMask (1) << stage)) != 0)
+                filter.reset();
+        };
+
+        for (auto& chain : chains)
+            forEachStage (chain, resetIfSelected);
+
+        for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+            if ((stages & (StageMask (1) << stage)) != 0)
+                simdCascade.resetStage (stage);
+    }
+
+    /** Loads a stage's coefficients into every channel. */
+    void setStageCoefficients (int stage, const BiquadCoefficients<double>& newCoefficients) noexcept
+    {
+        newCoefficients.copyTo (coefficients[(size_t) stage]->getRawCoefficients());
+        newCoefficients.copyTo (secondChannelCoefficients[(size_t) stage]->getRawCoefficients());
+        simdCascade.setStageCoefficients (stage, newCoefficients);
+    }
+
+    /** Overrides a stage's coefficients for the second channel only: the right
+        channel in left/right mode, the side signal in mid/side mode. Call after
+        setStageCoefficients(), which overwrites it.
+    */
+    void setSecondChannelStageCoefficients (int stage, const BiquadCoefficients<double>& newCoefficients) noexcept
+    {
+        newCoefficients.copyTo (secondChannelCoefficients[(size_t) stage]->getRawCoefficients());
+
+        if (simdCascade.getNumChannels() > 1)
+            simdCascade.setStageCoefficients (stage, 1, newCoefficients);
+    }
+
+    //==============================================================================
+    /** Filters a stretch of samples that shares one set of coefficients, either
+        through the SIMD kernel or channel by channel through the chains. With
+        midSide set, the first two channels are filtered as mid and side.
+    */
+    void process (juce::dsp::AudioBlock<SampleType> block, bool useSimd, const StageBypass& bypass,
+                  bool midSide = false) noexcept
+    {
+        if (useSimd)
+        {
+            simdCascade.process (block, bypass, midSide);
+            return;
+        }
+
+        auto numChannels = juce::jmin (chains.size(), block.getNumChannels());
+        midSide = midSide && numChannels > 1;
+
+        // The reference path codes in place around the chains rather than in
+        // the same pass, it is there to be obviously right, not fast
+        if (midSide)
+            convertMidSide (block, true);
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+            processChain (chains[channel], block.getSingleChannelBlock (channel), bypass);
+
+        if (midSide)
+            convertMidSide (block, false);
+    }
+
+private:
+    //==============================================================================
+    /** Calls fn (filter, stageIndex) for every stage of a chain. */
+    template <typename Function>
+    static void forEachStage (MonoChain<SampleType>& chain, Function&& fn)
+    {
+        for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+            fn (chain[(size_t) stage], stage);
+    }
+
+    /** Runs one channel through a chain, skipping and crossfading stages as the
+        bypass says.
+    */
+    static void processChain (MonoChain<SampleType>& chain, juce::dsp::AudioBlock<SampleType> block,
+                              const StageBypass& bypass) noexcept
+    {
+        forEachStage (chain, [&block, &bypass] (Filter& filter, int stage)
+        {
+            if (! bypass.isProcessed (stage))
+                return;
+
+            if (! bypass.isFading (stage))
+            {
+                juce::dsp::ProcessContextReplacing<SampleType> context (block);
+                filter.process (context);
+                return;
+            }
+
+            // Blend per sample; the filter itself still sees its own output
+            auto fade = bypass.getFade (stage);
+            auto* samples = block.getChannelPointer (0);
+
+            for (int i = 0; i < (int) block.getNumSamples(); ++i)
+            {
+                auto input = samples[i];
+                samples[i] = input + (filter.processSample (input) - input) * (SampleType) fade.getGain (i);
+            }
+        });
+    }
+
+    /** Left/right to mid/side of the first two channels, or back. */
+    static void convertMidSide (juce::dsp::AudioBlock<SampleType> block, bool encode) noexcept
+    {
+        auto* first = block.getChannelPointer (0);
+        auto* second = block.getChannelPointer (1);
+        auto scale = encode ? (SampleType) 0.5 : (SampleType) 1;
+
+        for (size_t i = 0; i < block.getNumSamples(); ++i)
+        {
+            auto sum = first[i] + second[i];
+            auto difference = first[i] - second[i];
+            first[i] = sum * scale;
+            second[i] = difference * scale;
+        }
+    }
+
+    //==============================================================================
+    std::vector<MonoChain<SampleType>> chains;
+    std::array<typename juce::dsp::IIR::Coefficients<SampleType>::Ptr, ChainPositions::numChainStages> coefficients,
+                                                                                                        secondChannelCoefficients;
+    SimdBiquadCascade<SampleType> simdCascade;
+};
@@ -0,0 +1,143 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEq.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEq.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+LinearPhaseEq::LinearPhaseEq (const ChainParameters& parametersToUse,
+                              std::atomic<float>* enabledParameterToUse,
+                              juce::TimeSliceThread& threadToUse)
+    : parameters (parametersToUse),
+      enabledParameter (enabledParameterToUse),
+      thread (threadToUse)
+{
+    thread.addTimeSliceClient (this);
+}
+
+LinearPhaseEq::~LinearPhaseEq()
+{
+    thread.removeTimeSliceClient (this);
+}
+
+int LinearPhaseEq::getKernelLength (double sampleRate) noexcept
+{
+    if (sampleRate <= 50000.0)   return 8192;
+    if (sampleRate <= 100000.0)  return 16384;
+
+    return 32768;
+}
+
+//==============================================================================
+void LinearPhaseEq::prepare (double newSampleRate, int numChannels)
+{
+    RealtimeSafety::checkBlockingCall ("LinearPhaseEq::prepare");
+
+    const juce::ScopedLock sl (designLock);
+
+    sampleRate = newSampleRate;
+    wasEnabled = isEnabled();
+    kernelLength = getKernelLength (sampleRate);
+    convolver.prepare (numChannels, partitionSize, kernelLength);
+    latencySamples = kernelLength / 2 + convolver.getLatencySamples();
+
+    designedSettings = getTargetSettings();
+    auto impulse = designImpulse (designedSettings);
+    convolver.setKernelNow (convolver.makeKernel (impulse.data(), (int) impulse.size()));
+}
+
+int LinearPhaseEq::useTimeSlice()
+{
+    const juce::ScopedLock sl (designLock);
+
+    if (sampleRate <= 0.0)
+        return 100;
+
+    convolver.collectGarbage();
+
+    auto enabled = isEnabled();
+
+    if (enabled != wasEnabled)
+    {
+        wasEnabled = enabled;
+
+        if (onEnablementChanged != nullptr)
+            onEnablementChanged();
+    }
+
+    if (! enabled)
+        return 50;
+
+    auto settings = getTargetSettings();
+
+    if (settings == designedSettings || ! convolver.canQueueKernel())
+        return 20;
+
+    auto impulse = designImpulse (settings);
+
+    if (convolver.queueKernel (convolver.makeKernel (impulse.data(), (int) impulse.size())))
+        designedSettings = settings;
+
+    return 20;
+}
+
+std::vector<float> LinearPhaseEq::designImpulse (const ChainSettings& settings) const
+{
+    // Frequency sampling on kernelLength bins: zero-phase magnitude in, real
+    // symmetric impulse out, then rotated by half the length and windowed
+    auto order = 0;
+
+    while ((1 << order) < kernelLength)
+        ++order;
+
+    juce::dsp::FFT fft (order);
+    std::vector<float> data ((size_t) (2 * kernelLength), 0.0f);
+
+    std::array<BiquadCoefficients<double>, ChainPositions::numChainStages> stages;
+    auto numActive = 0;
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+        if (! settings.isStageNeutral (stage))
+            stages[(size_t) numActive++] = CoefficientEngine::designStage (sampleRate, settings, stage,
+                                                                         settings.getStageValue (stage));
+
+    for (int bin = 0; bin <= kernelLength / 2; ++bin)
+    {
+        auto frequency = bin * sampleRate / kernelLength;
+        auto magnitude = 1.0;
+
+        for (int i = 0; i < numActive; ++i)
+            magnitude *= stages[(size_t) i].getMagnitude (frequency, sampleRate);
+
+        data[(size_t) (2 * bin)] = (float) magnitude;
+        data[(size_t) (2 * bin + 1)] = 0.0f;
+    }
+
+    fft.performRealOnlyInverseTransform (data.data());
+
+    // Normalise against a flat response to cancel the FFT's inverse scaling
+    std::vector<float> flat ((size_t) (2 * kernelLength), 0.0f);
+
+    for (int bin = 0; bin <= kernelLength / 2; ++bin)
+        flat[(size_t) (2 * bin)] = 1.0f;
+
+    fft.performRealOnlyInverseTransform (flat.data());
+    auto scale = 1.0f / flat[0];
+
+    std::vector<float> window ((size_t) kernelLength + 1);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), window.size(),
+                                                              juce::dsp::WindowingFunction<float>::blackmanHarris, false);
+
+    std::vector<float> impulse ((size_t) kernelLength);
+    auto half = kernelLength / 2;
+
+    for (int i = 0; i < kernelLength; ++i)
+        impulse[(size_t) i] = data[(size_t) ((i + half) % kernelLength)] * scale * window[(size_t) i];
+
+    return impulse;
+}
@@ -0,0 +1,85 @@
+/*
+  ==============================================================================
+
+    LinearPhaseEq.h
+
+    Linear-phase alternative to the IIR cascade. A background thread turns the
+    magnitude response of the current settings into a symmetric FIR whenever
+    they change, and the audio thread runs it through a PartitionedConvolver.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CoefficientEngine.h"
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+class LinearPhaseEq  : private juce::TimeSliceClient
+{
+public:
+    LinearPhaseEq (const ChainParameters& parametersToUse,
+                   std::atomic<float>* enabledParameterToUse,
+                   juce::TimeSliceThread& threadToUse);
+    ~LinearPhaseEq() override;
+
+    //==============================================================================
+    /** Allocates the convolver and builds a first kernel, so output is valid
+        straight away. Call from prepareToPlay.
+    */
+    void prepare (double sampleRate, int numChannels);
+
+    void reset() noexcept                 { convolver.reset(); }
+
+    template <typename SampleType>
+    void process (const juce::dsp::AudioBlock<SampleType>& block) noexcept    { convolver.process (block); }
+
+    bool isEnabled() const noexcept       { return enabledParameter->load() >= 0.5f; }
+
+    /** Delay of the FIR's centre tap plus the convolver's buffering. */
+    int getLatencySamples() const noexcept    { return latencySamples.load(); }
+
+    /** Called from the background thread when the mode is switched, so the
+        owner can report the new latency. It may come up to one timeslice
+        after the audio thread has already switched.
+    */
+    std::function<void()> onEnablementChanged;
+
+    /** Where the kernel's settings come from, if not straight from the
+        parameters. Called from prepare() and the background thread.
+    */
+    std::function<ChainSettings()> settingsSource;
+
+    /** FIR length for a sample rate: about 170 ms, enough resolution for the 31 Hz band. */
+    static int getKernelLength (double sampleRate) noexcept;
+
+private:
+    //==============================================================================
+    int useTimeSlice() override;
+
+    ChainSettings getTargetSettings() const    { return settingsSource != nullptr ? settingsSource() : getChainSettings (parameters); }
+
+    /** Samples the cascade's magnitude response and turns it into a windowed,
+        zero-phase FIR delayed by half its length.
+    */
+    std::vector<float> designImpulse (const ChainSettings& settings) const;
+
+    //==============================================================================
+    static constexpr int partitionSize = 512;
+
+    const ChainParameters& parameters;
+    std::atomic<float>* enabledParameter;
+    juce::TimeSliceThread& thread;
+
+    juce::CriticalSection designLock;
+    PartitionedConvolver convolver;
+
+    double sampleRate = 0.0;
+    int kernelLength = 0;
+    std::atomic<int> latencySamples { 0 };
+    ChainSettings designedSettings;
+    bool wasEnabled = false;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseEq)
+};
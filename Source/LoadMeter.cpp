@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    LoadMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LoadMeter.h"
+
+//==============================================================================
+LoadMeter::LoadMeter()
+    : secondsPerTick (1.0 / (double) juce::Time::getHighResolutionTicksPerSecond())
+{
+    clear();
+}
+
+void LoadMeter::prepare (double newSampleRate) noexcept
+{
+    sampleRate = newSampleRate;
+    resetRequested = true;
+}
+
+void LoadMeter::record (juce::int64 elapsedTicks, int numSamples) noexcept
+{
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return;
+
+    if (resetRequested.exchange (false))
+        clear();
+
+    auto load = (double) elapsedTicks * secondsPerTick * sampleRate / (double) numSamples;
+
+    // A single writer, so plain load/store pairs are enough
+    auto& bucket = buckets[(size_t) getBucket (load)];
+    bucket.store (bucket.load (std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    totalLoad.store (totalLoad.load (std::memory_order_relaxed) + load, std::memory_order_relaxed);
+    lastLoad.store (load, std::memory_order_relaxed);
+
+    if (load > maxLoad.load (std::memory_order_relaxed))
+        maxLoad.store (load, std::memory_order_relaxed);
+
+    numCalls.store (numCalls.load (std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+LoadMeter::Statistics LoadMeter::getStatistics() const noexcept
+{
+    Statistics statistics;
+    statistics.numCalls = numCalls.load (std::memory_order_acquire);
+
+    if (statistics.numCalls == 0)
+        return statistics;
+
+    std::array<juce::uint32, numBuckets> counts;
+    juce::int64 total = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+        total += (counts[(size_t) i] = buckets[(size_t) i].load (std::memory_order_relaxed));
+
+    auto findPercentile = [&] (double fraction)
+    {
+        auto target = (juce::int64) std::ceil (fraction * (double) total);
+        juce::int64 seen = 0;
+
+        for (int i = 0; i < numBuckets; ++i)
+            if ((seen += counts[(size_t) i]) >= target)
+                return getBucketLoad (i);
+
+        return getBucketLoad (numBuckets - 1);
+    };
+
+    statistics.mean = totalLoad.load (std::memory_order_relaxed) / (double) statistics.numCalls;
+    statistics.p50 = findPercentile (0.5);
+    statistics.p99 = findPercentile (0.99);
+    statistics.max = maxLoad.load (std::memory_order_relaxed);
+    statistics.last = lastLoad.load (std::memory_order_relaxed);
+    return statistics;
+}
+
+//==============================================================================
+int LoadMeter::getBucket (double load) noexcept
+{
+    if (load <= minimumLoad)
+        return 0;
+
+    auto position = std::log (load / minimumLoad) / std::log (maximumLoad / minimumLoad);
+    return juce::jlimit (0, numBuckets - 1, (int) (position * (numBuckets - 1)));
+}
+
+double LoadMeter::getBucketLoad (int bucket) noexcept
+{
+    // Report a bucket by its upper edge, so percentiles err on the high side
+    return minimumLoad * std::pow (maximumLoad / minimumLoad, (double) (bucket + 1) / (numBuckets - 1));
+}
+
+void LoadMeter::clear() noexcept
+{
+    for (auto& bucket : buckets)
+        bucket.store (0, std::memory_order_relaxed);
+
+    totalLoad = 0.0;
+    maxLoad = 0.0;
+    lastLoad = 0.0;
+    numCalls = 0;
+}
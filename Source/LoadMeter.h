@@ -0,0 +1,88 @@
+/*
+  ==============================================================================
+
+    LoadMeter.h
+
+    Measures how much of its real-time budget each processBlock call uses and
+    keeps a histogram of the results. The audio thread is the only writer and
+    only touches atomics; any other thread can read statistics at any time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class LoadMeter
+{
+public:
+    /** A summary of the calls since the last reset. Loads are fractions of the
+        block's duration, so 0.01 means the call took 1% of the time available.
+    */
+    struct Statistics
+    {
+        juce::int64 numCalls = 0;
+        double mean = 0.0, p50 = 0.0, p99 = 0.0, max = 0.0, last = 0.0;
+    };
+
+    /** Times one call from construction to destruction. */
+    class ScopedMeasurement
+    {
+    public:
+        ScopedMeasurement (LoadMeter& meterToUse, int numSamplesToUse) noexcept
+            : meter (meterToUse), numSamples (numSamplesToUse), start (juce::Time::getHighResolutionTicks())
+        {
+        }
+
+        ~ScopedMeasurement() noexcept
+        {
+            meter.record (juce::Time::getHighResolutionTicks() - start, numSamples);
+        }
+
+    private:
+        LoadMeter& meter;
+        int numSamples;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedMeasurement)
+    };
+
+    //==============================================================================
+    LoadMeter();
+
+    /** Sets the rate the block budgets are worked out from. */
+    void prepare (double sampleRate) noexcept;
+
+    /** Adds one call that took the given number of high-resolution ticks to
+        process numSamples. Audio thread only.
+    */
+    void record (juce::int64 elapsedTicks, int numSamples) noexcept;
+
+    /** Asks the audio thread to clear the histogram before its next record(). */
+    void reset() noexcept    { resetRequested = true; }
+
+    /** Safe from any thread; percentiles are accurate to one histogram bucket. */
+    Statistics getStatistics() const noexcept;
+
+private:
+    //==============================================================================
+    // Log-spaced buckets from 0.01% to 1000% of the budget, about 9% apart
+    static constexpr int numBuckets = 128;
+    static constexpr double minimumLoad = 1.0e-4, maximumLoad = 10.0;
+
+    static int getBucket (double load) noexcept;
+    static double getBucketLoad (int bucket) noexcept;
+
+    void clear() noexcept;
+
+    double secondsPerTick = 0.0, sampleRate = 44100.0;
+
+    std::array<std::atomic<juce::uint32>, numBuckets> buckets;
+    std::atomic<juce::int64> numCalls { 0 };
+    std::atomic<double> totalLoad { 0.0 }, maxLoad { 0.0 }, lastLoad { 0.0 };
+    std::atomic<bool> resetRequested { false };
+
+    JUCE_DECLARE_NON_COPYABLE (LoadMeter)
+};
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    OversamplingBank.cpp
+
+  ==============================================================================
+*/
+
+#include "OversamplingBank.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+template <typename SampleType>
+void OversamplingBank<SampleType>::prepare (int numChannels, int maximumBlockSize)
+{
+    RealtimeSafety::checkBlockingCall ("OversamplingBank::prepare");
+
+    for (int factorIndex = 1; factorIndex < numFactors; ++factorIndex)
+    {
+        for (int qualityIndex = 0; qualityIndex < numQualities; ++qualityIndex)
+        {
+            auto quality = (Quality) qualityIndex;
+            auto filterType = (quality == Quality::polyphaseIIR || quality == Quality::polyphaseIIRMaxQuality)
+                                ? Oversampler::filterHalfBandPolyphaseIIR
+                                : Oversampler::filterHalfBandFIREquiripple;
+            auto isMaxQuality = (quality == Quality::polyphaseIIRMaxQuality || quality == Quality::equirippleFIRMaxQuality);
+
+            // Integer latency so the host can compensate for it exactly
+            auto& oversampler = oversamplers[(size_t) ((factorIndex - 1) * numQualities + qualityIndex)];
+            oversampler = std::make_unique<Oversampler> ((size_t) numChannels, (size_t) factorIndex,
+                                                         filterType, isMaxQuality, true);
+            oversampler->initProcessing ((size_t) maximumBlockSize);
+        }
+    }
+}
+
+template <typename SampleType>
+typename OversamplingBank<SampleType>::Oversampler* OversamplingBank<SampleType>::get (int factorIndex, int qualityIndex) const noexcept
+{
+    factorIndex = juce::jlimit (0, numFactors - 1, factorIndex);
+    qualityIndex = juce::jlimit (0, numQualities - 1, qualityIndex);
+
+    if (factorIndex == 0)
+        return nullptr;
+
+    return oversamplers[(size_t) ((factorIndex - 1) * numQualities + qualityIndex)].get();
+}
+
+template class OversamplingBank<float>;
+template class OversamplingBank<double>;
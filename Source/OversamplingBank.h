@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    OversamplingBank.h
+
+    Every oversampling factor and filter quality the plugin offers, built up
+    front so that switching between them on the audio thread is just a
+    pointer change.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** The choices behind the "Oversampling" and "Oversampling Filter" parameters. */
+struct OversamplingOptions
+{
+    /** Indices of the "Oversampling" parameter: off, 2x, 4x. */
+    static constexpr int numFactors = 3;
+
+    /** Indices of the "Oversampling Filter" parameter, from cheapest to best. */
+    enum class Quality
+    {
+        polyphaseIIR,
+        polyphaseIIRMaxQuality,
+        equirippleFIR,
+        equirippleFIRMaxQuality,
+        numQualities
+    };
+
+    static constexpr int numQualities = (int) Quality::numQualities;
+
+    static juce::StringArray getFactorNames()     { return { "Off", "2x", "4x" }; }
+    static juce::StringArray getQualityNames()    { return { "IIR", "IIR (max quality)", "FIR", "FIR (max quality)" }; }
+
+    static int getFactor (int factorIndex) noexcept    { return 1 << juce::jlimit (0, numFactors - 1, factorIndex); }
+};
+
+//==============================================================================
+template <typename SampleType>
+class OversamplingBank  : public OversamplingOptions
+{
+public:
+    using Oversampler = juce::dsp::Oversampling<SampleType>;
+
+    //==============================================================================
+    /** Builds and initialises every oversampler. Not for the audio thread. */
+    void prepare (int numChannels, int maximumBlockSize);
+
+    /** The oversampler for a pair of parameter indices, or nullptr when
+        oversampling is off. Never allocates.
+    */
+    Oversampler* get (int factorIndex, int qualityIndex) const noexcept;
+
+    /** Resets the oversampler for a pair of parameter indices, if there is one. */
+    void reset (int factorIndex, int qualityIndex) noexcept
+    {
+        if (auto* oversampler = get (factorIndex, qualityIndex))
+            oversampler->reset();
+    }
+
+private:
+    // Factor 1 needs no oversampler, so slot 0 holds 2x
+    std::array<std::unique_ptr<Oversampler>, (size_t) ((numFactors - 1) * numQualities)> oversamplers;
+};
@@ -0,0 +1,397 @@
+/*
+  ==============================================================================
+
+    ParallelBiquadBank.h
+
+    Runs one channel through a sum of second-order sections instead of a
+    cascade: the output is a direct gain times the input plus every section's
+    output, and the sections don't feed each other, so numLanes of them run
+    at once in the lanes of a juce::dsp::SIMDRegister and the groups of lanes
+    don't wait on each other either.
+
+    The sections run in modal form: the state of each is the input filtered
+    by the section's poles alone, a complex pair as a rotation, which keeps
+    far more precision for low poles than a direct form does. When a new
+    expansion arrives, sections whose poles haven't moved keep their state as
+    it is, however much their outputs changed, and only the rest are primed
+    from a history of the input, spread over as many blocks as it takes.
+    The new expansion is then cross-faded in, rather than switched to.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CoefficientEngine.h"
+
+//==============================================================================
+/** The peak stages of a cascade as parallel sections, designed off the audio
+    thread and handed over whole.
+*/
+struct ParallelSections
+{
+    static constexpr int maxSections = maxPeakBands;
+
+    /** The two poles of one cascade stage, in state-space form:
+
+            s[n] = M s[n-1] + (1, g2) x[n],    y[n] = c1 s1[n] + c2 s2[n]
+
+        M rotates and scales a complex pair, or holds two real poles on its
+        diagonal. a1 and a2 are the stage's own denominator, by which an
+        unchanged section is recognised.
+    */
+    struct Section
+    {
+        int stage = 0;
+        double a1 = 0, a2 = 0;
+        double m11 = 0, m12 = 0, m21 = 0, m22 = 0, g2 = 0;
+        double c1 = 0, c2 = 0;
+    };
+
+    std::array<Section, maxSections> sections {};
+    int numSections = 0;
+    double direct = 1.0;
+    double sampleRate = 0.0;
+
+    /** False if the expansion didn't match the cascade closely enough to use. */
+    bool verified = false;
+
+    /** Counts up with every expansion; 0 is nothing designed yet. */
+    juce::uint32 version = 0;
+};
+
+//==============================================================================
+template <typename SampleType>
+class ParallelBiquadBank
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int numLanes = (int) Vector::size();
+    static constexpr int maxGroups = (ParallelSections::maxSections + numLanes - 1) / numLanes;
+
+    /** Section-samples of priming allowed per sample processed, about four
+        times the work of a full bank, so a switch that moves every pole is
+        spread over several blocks rather than done in one.
+    */
+    static constexpr int primingPerSample = 4 * ParallelSections::maxSections;
+
+    //==============================================================================
+    /** Allocates the input history sections are primed from. Not for the audio thread. */
+    void prepare (int historyLength)
+    {
+        history.assign ((size_t) juce::jmax (1, historyLength), 0);
+        samplesWritten = 0;
+        reset();
+    }
+
+    /** Clears the section state and forgets the input history. A switch under
+        way lands at once, as there is nothing left to fade from.
+    */
+    void reset() noexcept
+    {
+        if (phase != Phase::steady)
+        {
+            active = 1 - active;
+            phase = Phase::steady;
+        }
+
+        for (auto& layer : layers)
+            for (auto& group : layer.groups)
+                group.s1 = group.s2 = Vector::expand (0);
+
+        historyUsed = 0;
+    }
+
+    /** The version of the expansion last loaded, whether or not the switch to
+        it has finished. */
+    juce::uint32 getVersion() const noexcept
+    {
+        return layers[(size_t) (phase == Phase::steady ? active : 1 - active)].sections.version;
+    }
+
+    /** True from load() until the bank runs the new expansion alone; no other
+        can be loaded meanwhile. */
+    bool isSwitching() const noexcept    { return phase != Phase::steady; }
+
+    //==============================================================================
+    /** Starts switching to a new expansion. Sections with the same stage and
+        poles as before carry on where they are, the others are primed from the
+        input history, a share of it each block, so they join in as if they had
+        been running all along. Once they have caught up the bank cross-fades to
+        the new expansion over CoefficientEngine::smoothingTimeSeconds, as the
+        cascade ramps over. Straight after a reset it switches at once.
+    */
+    void load (const ParallelSections& newSections) noexcept
+    {
+        if (phase != Phase::steady)
+            return;
+
+        auto& current = layers[(size_t) active];
+        auto& incoming = layers[(size_t) (1 - active)];
+        incoming.setSections (newSections);
+
+        if (historyUsed == 0)
+        {
+            active = 1 - active;
+            return;
+        }
+
+        numPending = 0;
+
+        for (int i = 0; i < incoming.sections.numSections; ++i)
+        {
+            auto& section = incoming.sections.sections[(size_t) i];
+            sources[(size_t) i] = current.findSection (section);
+
+            if (sources[(size_t) i] >= 0)
+                continue;
+
+            // Only as much history as the poles would still remember
+            BiquadCoefficients<double> poles;
+            poles.a1 = section.a1;
+            poles.a2 = section.a2;
+
+            auto decay = poles.getDecayLength (CoefficientEngine::tailDecibels);
+            auto length = std::isfinite (decay) ? juce::jmin (historyUsed, (int) std::ceil (decay)) : historyUsed;
+
+            pending[(size_t) numPending++] = { i, 0.0, 0.0, samplesWritten - length };
+        }
+
+        fadeLength = juce::jmax (1, juce::roundToInt (CoefficientEngine::smoothingTimeSeconds * newSections.sampleRate));
+        phase = Phase::priming;
+
+        if (numPending == 0)
+            startFade();
+    }
+
+    //==============================================================================
+    /** Filters numSamples in place. */
+    void process (SampleType* samples, int numSamples) noexcept
+    {
+        if (phase == Phase::priming)
+            continuePriming (numSamples);
+
+        auto* current = &layers[(size_t) active];
+        auto* incoming = &layers[(size_t) (1 - active)];
+        auto historySize = (int) history.size();
+        auto historyWrite = (int) (samplesWritten % historySize);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto x = samples[i];
+
+            history[(size_t) historyWrite] = x;
+            historyWrite = historyWrite + 1 < historySize ? historyWrite + 1 : 0;
+
+            auto y = current->process (x);
+
+            if (phase == Phase::fading)
+            {
+                auto fade = (SampleType) ++fadePosition / (SampleType) fadeLength;
+                y += fade * (incoming->process (x) - y);
+
+                if (fadePosition == fadeLength)
+                {
+                    active = 1 - active;
+                    current = incoming;
+                    phase = Phase::steady;
+                }
+            }
+
+            samples[i] = y;
+        }
+
+        samplesWritten += numSamples;
+        historyUsed = juce::jmin (historySize, historyUsed + numSamples);
+    }
+
+private:
+    //==============================================================================
+    struct Group
+    {
+        Vector m11 { Vector::expand (0) }, m12 { Vector::expand (0) }, m21 { Vector::expand (0) }, m22 { Vector::expand (0) };
+        Vector g2 { Vector::expand (0) }, c1 { Vector::expand (0) }, c2 { Vector::expand (0) };
+        Vector s1 { Vector::expand (0) }, s2 { Vector::expand (0) };
+    };
+
+    /** One expansion, loaded into lanes. */
+    struct Layer
+    {
+        /** Loads the coefficients with all state cleared. Unused lanes get
+            all-zero coefficients, and output nothing. */
+        void setSections (const ParallelSections& newSections) noexcept
+        {
+            sections = newSections;
+            numGroups = (sections.numSections + numLanes - 1) / numLanes;
+            direct = (SampleType) sections.direct;
+
+            for (int g = 0; g < maxGroups; ++g)
+            {
+                auto& group = groups[(size_t) g];
+                group = Group();
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    auto i = g * numLanes + lane;
+
+                    if (i >= sections.numSections)
+                        break;
+
+                    auto& section = sections.sections[(size_t) i];
+                    group.m11.set ((size_t) lane, (SampleType) section.m11);
+                    group.m12.set ((size_t) lane, (SampleType) section.m12);
+                    group.m21.set ((size_t) lane, (SampleType) section.m21);
+                    group.m22.set ((size_t) lane, (SampleType) section.m22);
+                    group.g2.set ((size_t) lane, (SampleType) section.g2);
+                    group.c1.set ((size_t) lane, (SampleType) section.c1);
+                    group.c2.set ((size_t) lane, (SampleType) section.c2);
+                }
+            }
+        }
+
+        /** Index of the section with the same stage and poles, or -1. */
+        int findSection (const ParallelSections::Section& section) const noexcept
+        {
+            for (int i = 0; i < sections.numSections; ++i)
+            {
+                auto& other = sections.sections[(size_t) i];
+
+                if (other.stage == section.stage && other.a1 == section.a1 && other.a2 == section.a2)
+                    return i;
+            }
+
+            return -1;
+        }
+
+        void getState (int section, double& s1, double& s2) const noexcept
+        {
+            auto& group = groups[(size_t) (section / numLanes)];
+            s1 = (double) group.s1.get ((size_t) (section % numLanes));
+            s2 = (double) group.s2.get ((size_t) (section % numLanes));
+        }
+
+        void setState (int section, double s1, double s2) noexcept
+        {
+            auto& group = groups[(size_t) (section / numLanes)];
+            group.s1.set ((size_t) (section % numLanes), (SampleType) s1);
+            group.s2.set ((size_t) (section % numLanes), (SampleType) s2);
+        }
+
+        SampleType process (SampleType x) noexcept
+        {
+            auto input = Vector::expand (x);
+            auto sum = Vector::expand (0);
+
+            for (int g = 0; g < numGroups; ++g)
+            {
+                auto& group = groups[(size_t) g];
+                auto s1 = input + (group.m11 * group.s1) + (group.m12 * group.s2);
+                auto s2 = (group.g2 * input) + (group.m21 * group.s1) + (group.m22 * group.s2);
+                sum += (group.c1 * s1) + (group.c2 * s2);
+                group.s1 = s1;
+                group.s2 = s2;
+            }
+
+            return direct * x + sum.sum();
+        }
+
+        std::array<Group, maxGroups> groups;
+        int numGroups = 0;
+        SampleType direct = 1;
+        ParallelSections sections;
+    };
+
+    /** A section of the incoming expansion being primed, with its state and
+        the next sample of history it needs. */
+    struct Priming
+    {
+        int section;
+        double s1, s2;
+        juce::int64 position;
+    };
+
+    enum class Phase
+    {
+        steady,     // the active layer runs alone
+        priming,    // the incoming layer's moved sections catch up on the history
+        fading      // both run, fading from the active layer to the incoming one
+    };
+
+    //==============================================================================
+    /** Runs every pending section's poles over its share of this block's priming
+        budget, and starts the fade once all have reached the newest input.
+        The budget is split evenly, so each gains on the input every block.
+    */
+    void continuePriming (int numSamples) noexcept
+    {
+        auto& incoming = layers[(size_t) (1 - active)];
+        auto budget = (juce::int64) primingPerSample * numSamples / numPending;
+        auto historySize = (juce::int64) history.size();
+        auto caughtUp = true;
+
+        for (int p = 0; p < numPending; ++p)
+        {
+            auto& item = pending[(size_t) p];
+            auto& section = incoming.sections.sections[(size_t) item.section];
+            auto end = juce::jmin (samplesWritten, item.position + budget);
+            auto index = (int) (item.position % historySize);
+
+            for (auto n = item.position; n < end; ++n)
+            {
+                auto x = (double) history[(size_t) index];
+                auto next1 = x + section.m11 * item.s1 + section.m12 * item.s2;
+                auto next2 = section.g2 * x + section.m21 * item.s1 + section.m22 * item.s2;
+                item.s1 = next1;
+                item.s2 = next2;
+                index = index + 1 < (int) historySize ? index + 1 : 0;
+            }
+
+            item.position = end;
+            caughtUp = caughtUp && end == samplesWritten;
+        }
+
+        if (caughtUp)
+            startFade();
+    }
+
+    /** Hands the incoming layer its state, all as of the newest input: primed
+        sections from priming, unmoved ones from the active layer.
+    */
+    void startFade() noexcept
+    {
+        auto& current = layers[(size_t) active];
+        auto& incoming = layers[(size_t) (1 - active)];
+
+        for (int p = 0; p < numPending; ++p)
+            incoming.setState (pending[(size_t) p].section, pending[(size_t) p].s1, pending[(size_t) p].s2);
+
+        for (int i = 0; i < incoming.sections.numSections; ++i)
+        {
+            if (sources[(size_t) i] >= 0)
+            {
+                double s1, s2;
+                current.getState (sources[(size_t) i], s1, s2);
+                incoming.setState (i, s1, s2);
+            }
+        }
+
+        numPending = 0;
+        fadePosition = 0;
+        phase = Phase::fading;
+    }
+
+    //==============================================================================
+    std::array<Layer, 2> layers;
+    int active = 0;
+    Phase phase = Phase::steady;
+
+    std::array<int, ParallelSections::maxSections> sources {};
+    std::array<Priming, ParallelSections::maxSections> pending {};
+    int numPending = 0;
+    int fadeLength = 1, fadePosition = 0;
+
+    std::vector<SampleType> history;
+    juce::int64 samplesWritten = 0;
+    int historyUsed = 0;
+};
@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    ParallelEq.cpp
+
+  ==============================================================================
+*/
+
+#include "ParallelEq.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+ParallelEq::ParallelEq (const ChainParameters& parametersToUse,
+                        std::atomic<float>* enabledParameterToUse,
+                        juce::TimeSliceThread& threadToUse)
+    : parameters (parametersToUse),
+      enabledParameter (enabledParameterToUse),
+      thread (threadToUse)
+{
+    thread.addTimeSliceClient (this);
+}
+
+ParallelEq::~ParallelEq()
+{
+    thread.removeTimeSliceClient (this);
+}
+
+//==============================================================================
+void ParallelEq::prepare (double newSampleRate, double maximumSampleRate)
+{
+    RealtimeSafety::checkBlockingCall ("ParallelEq::prepare");
+
+    const juce::ScopedLock sl (designLock);
+
+    sampleRate = newSampleRate;
+
+    auto historyLength = (int) std::ceil (maximumSampleRate * historySeconds);
+    floatBank.prepare (historyLength);
+    doubleBank.prepare (historyLength);
+
+    design (getTargetSettings(), newSampleRate);
+}
+
+void ParallelEq::update()
+{
+    RealtimeSafety::checkBlockingCall ("ParallelEq::update");
+
+    const juce::ScopedLock sl (designLock);
+
+    auto rate = sampleRate.load();
+    auto settings = getTargetSettings();
+
+    if (rate > 0.0 && ! (settings == designedSettings && rate == designedRate))
+        design (settings, rate);
+}
+
+bool ParallelEq::isReady() noexcept
+{
+    latest = &expansions.read();
+    return latest->verified && latest->sampleRate == sampleRate.load();
+}
+
+int ParallelEq::useTimeSlice()
+{
+    const juce::ScopedLock sl (designLock);
+
+    auto rate = sampleRate.load();
+
+    if (rate <= 0.0 || ! isEnabled())
+        return 50;
+
+    auto settings = getTargetSettings();
+
+    if (settings == designedSettings && rate == designedRate)
+        return 10;
+
+    design (settings, rate);
+    return 10;
+}
+
+void ParallelEq::design (const ChainSettings& settings, double rate)
+{
+    auto expansion = expand (settings, rate);
+    expansion.verified = measureDeviation (settings, expansion) <= maximumDeviation;
+
+    designedSettings = settings;
+    designedRate = rate;
+
+    // One setting the expansion can't match, passed on a drag, mustn't throw
+    // the audio thread back onto the cascade; the last good one plays on
+    if (! expansion.verified)
+        return;
+
+    expansion.version = nextVersion++;
+    expansions.write (expansion);
+}
+
+//==============================================================================
+ParallelSections ParallelEq::expand (const ChainSettings& settings, double sampleRate)
+{
+    using Complex = std::complex<double>;
+
+    ParallelSections result;
+    result.sampleRate = sampleRate;
+
+    std::array<BiquadCoefficients<double>, ParallelSections::maxSections> cascade;
+    std::array<Complex, ParallelSections::maxSections> poles, partners;
+    auto& n = result.numSections;
+
+    for (int band = 0; band < maxPeakBands; ++band)
+    {
+        auto stage = getPeakStage (band);
+
+        if (settings.isStageNeutral (stage))
+            continue;
+
+        auto& c = cascade[(size_t) n];
+        c = CoefficientEngine::designStage (sampleRate, settings, stage, settings.getStageValue (stage));
+
+        // The two roots of z^2 + a1 z + a2, so 1 + a1 z^-1 + a2 z^-2 = (1 - p z^-1) (1 - q z^-1)
+        auto root = std::sqrt (Complex (c.a1 * c.a1 - 4.0 * c.a2));
+        poles[(size_t) n] = 0.5 * (-c.a1 + root);
+        partners[(size_t) n] = 0.5 * (-c.a1 - root);
+
+        auto& section = result.sections[(size_t) n];
+        section.stage = stage;
+        section.a1 = c.a1;
+        section.a2 = c.a2;
+        ++n;
+    }
+
+    // What's left of the cascade as z^-1 grows without bound: each stage tends to b2 / a2
+    for (int k = 0; k < n; ++k)
+        result.direct *= cascade[(size_t) k].b2 / cascade[(size_t) k].a2;
+
+    // The residue at a pole p of stage k, for a term r / (1 - p z^-1), is stage k
+    // with that pole cancelled times every other stage, all evaluated at z = p
+    auto getResidue = [&] (int k, Complex p, Complex q)
+    {
+        auto& c = cascade[(size_t) k];
+        auto residue = (c.b0 * p * p + c.b1 * p + c.b2) / (p * (p - q));
+
+        for (int j = 0; j < n; ++j)
+            if (j != k)
+                residue *= cascade[(size_t) j].getResponse (1.0 / p);
+
+        return residue;
+    };
+
+    for (int k = 0; k < n; ++k)
+    {
+        auto p = poles[(size_t) k], q = partners[(size_t) k];
+        auto rp = getResidue (k, p, q);
+        auto& section = result.sections[(size_t) k];
+
+        if (p.imag() != 0.0)
+        {
+            // The state is one complex mode v = s1 + j s2 with v[n] = p v[n-1] + x[n],
+            // and its conjugate adds the same again: y = 2 Re (rp v)
+            if (p.imag() < 0.0)
+            {
+                p = std::conj (p);
+                rp = std::conj (rp);
+            }
+
+            section.m11 = section.m22 = p.real();
+            section.m12 = -p.imag();
+            section.m21 = p.imag();
+            section.g2 = 0.0;
+            section.c1 = 2.0 * rp.real();
+            section.c2 = -2.0 * rp.imag();
+        }
+        else
+        {
+            // Two real modes side by side, each fed the input
+            section.m11 = p.real();
+            section.m22 = q.real();
+            section.m12 = section.m21 = 0.0;
+            section.g2 = 1.0;
+            section.c1 = rp.real();
+            section.c2 = getResidue (k, q, p).real();
+        }
+    }
+
+    return result;
+}
+
+std::complex<double> ParallelEq::getSectionResponse (const ParallelSections::Section& section, std::complex<double> z1) noexcept
+{
+    // c^T (I - M z^-1)^-1 (1, g2)^T, with the 2x2 inverse written out
+    auto d11 = 1.0 - section.m11 * z1, d12 = -section.m12 * z1;
+    auto d21 = -section.m21 * z1,      d22 = 1.0 - section.m22 * z1;
+    auto determinant = d11 * d22 - d12 * d21;
+
+    auto s1 = (d22 - d12 * section.g2) / determinant;
+    auto s2 = (d11 * section.g2 - d21) / determinant;
+
+    return section.c1 * s1 + section.c2 * s2;
+}
+
+double ParallelEq::measureDeviation (const ChainSettings& settings, const ParallelSections& expansion)
+{
+    constexpr int numPoints = 128;
+    auto highest = juce::jmin (20000.0, 0.49 * expansion.sampleRate);
+    auto deviation = 0.0;
+
+    std::array<BiquadCoefficients<double>, ParallelSections::maxSections> cascade;
+
+    for (int k = 0; k < expansion.numSections; ++k)
+    {
+        auto stage = expansion.sections[(size_t) k].stage;
+        cascade[(size_t) k] = CoefficientEngine::designStage (expansion.sampleRate, settings, stage, settings.getStageValue (stage));
+    }
+
+    for (int point = 0; point < numPoints; ++point)
+    {
+        auto frequency = 20.0 * std::pow (highest / 20.0, point / (double) (numPoints - 1));
+        auto z1 = std::polar (1.0, -juce::MathConstants<double>::twoPi * frequency / expansion.sampleRate);
+
+        std::complex<double> serial (1.0), parallel (expansion.direct);
+
+        for (int k = 0; k < expansion.numSections; ++k)
+        {
+            serial *= cascade[(size_t) k].getResponse (z1);
+            parallel += getSectionResponse (expansion.sections[(size_t) k], z1);
+        }
+
+        auto error = std::abs (parallel - serial) / std::abs (serial);
+
+        // NaN from a degenerate expansion must fail too
+        if (! (error <= deviation))
+            deviation = std::isfinite (error) ? error : std::numeric_limits<double>::infinity();
+    }
+
+    return deviation;
+}
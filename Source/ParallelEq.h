@@ -0,0 +1,139 @@
+/*
+  ==============================================================================
+
+    ParallelEq.h
+
+    Parallel-form alternative to the serial cascade for mono instances. A
+    background thread expands the peak bands of the current settings into a
+    sum of second-order sections by partial fractions whenever they change,
+    checks the expansion against the cascade's own response, and the audio
+    thread runs the latest one that passed through a ParallelBiquadBank.
+
+    The cut filters stay in the serial cascade in front of the bank: their
+    stacked sections share poles, which partial fractions can't separate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ParallelBiquadBank.h"
+#include "TripleBuffer.h"
+
+//==============================================================================
+class ParallelEq  : private juce::TimeSliceClient
+{
+public:
+    ParallelEq (const ChainParameters& parametersToUse,
+                std::atomic<float>* enabledParameterToUse,
+                juce::TimeSliceThread& threadToUse);
+    ~ParallelEq() override;
+
+    //==============================================================================
+    /** Allocates the input history for the highest rate the bank may run at and
+        expands the current settings, so output is valid straight away. Call
+        from prepareToPlay.
+    */
+    void prepare (double sampleRate, double maximumSampleRate);
+
+    /** Moves the design to another rate, when the oversampling changes. Safe
+        from the audio thread; until the background thread has caught up,
+        isReady() returns false.
+    */
+    void setSampleRate (double newSampleRate) noexcept    { sampleRate = newSampleRate; }
+
+    /** Expands the current settings on the spot if they changed, instead of
+        waiting for the background thread, for offline renders that need the
+        new expansion from a known block on. Not for the audio thread.
+    */
+    void update();
+
+    void reset() noexcept
+    {
+        floatBank.reset();
+        doubleBank.reset();
+    }
+
+    bool isEnabled() const noexcept    { return enabledParameter->load() >= 0.5f; }
+
+    /** Audio thread only: picks up the newest expansion and returns true if it
+        is verified and designed for the current rate, so process() can run.
+    */
+    bool isReady() noexcept;
+
+    /** Filters the block's first channel through the peak bands. A newer
+        expansion is faded in once the bank has finished switching to the last.
+    */
+    template <typename SampleType>
+    void process (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        auto& bank = getBank<SampleType>();
+
+        if (bank.getVersion() != latest->version && ! bank.isSwitching())
+            bank.load (*latest);
+
+        bank.process (block.getChannelPointer (0), (int) block.getNumSamples());
+    }
+
+    /** Where the expansion's settings come from, if not straight from the
+        parameters. Called from prepare() and the background thread.
+    */
+    std::function<ChainSettings()> settingsSource;
+
+    //==============================================================================
+    /** Expands the non-neutral peak stages of the settings into parallel form.
+        Not verified; see measureDeviation().
+    */
+    static ParallelSections expand (const ChainSettings& settings, double sampleRate);
+
+    /** The largest difference between the expansion's complex response and the
+        serial peak stages', relative to the latter, over the audio band.
+    */
+    static double measureDeviation (const ChainSettings& settings, const ParallelSections& expansion);
+
+    /** The complex response of one section at z^-1 = z1, as the bank runs it. */
+    static std::complex<double> getSectionResponse (const ParallelSections::Section& section, std::complex<double> z1) noexcept;
+
+    /** Deviation beyond which an expansion is rejected: -80 dB. */
+    static constexpr double maximumDeviation = 1.0e-4;
+
+private:
+    //==============================================================================
+    int useTimeSlice() override;
+
+    ChainSettings getTargetSettings() const    { return settingsSource != nullptr ? settingsSource() : getChainSettings (parameters); }
+
+    /** Expands, verifies and publishes the settings. Called with designLock held. */
+    void design (const ChainSettings& settings, double rate);
+
+    template <typename SampleType>
+    ParallelBiquadBank<SampleType>& getBank() noexcept
+    {
+        if constexpr (std::is_same<SampleType, float>::value)
+            return floatBank;
+        else
+            return doubleBank;
+    }
+
+    //==============================================================================
+    /** Input history for priming sections that have just moved. */
+    static constexpr double historySeconds = 0.5;
+
+    const ChainParameters& parameters;
+    std::atomic<float>* enabledParameter;
+    juce::TimeSliceThread& thread;
+
+    juce::CriticalSection designLock;
+    TripleBuffer<ParallelSections> expansions;
+    const ParallelSections* latest = nullptr;
+    juce::uint32 nextVersion = 1;
+
+    std::atomic<double> sampleRate { 0.0 };
+    ChainSettings designedSettings;
+    double designedRate = 0.0;
+
+    ParallelBiquadBank<float> floatBank;
+    ParallelBiquadBank<double> doubleBank;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParallelEq)
+};
@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+#include "RealtimeSafety.h"
+
+namespace
+{
+    int getOrderForSize (int size) noexcept
+    {
+        int order = 0;
+
+        while ((1 << order) < size)
+            ++order;
+
+        return order;
+    }
+}
+
+//==============================================================================
+PartitionedConvolver::~PartitionedConvolver()
+{
+    delete pendingKernel.exchange (nullptr);
+    delete retiredKernel.exchange (nullptr);
+}
+
+void PartitionedConvolver::prepare (int newNumChannels, int newPartitionSize, int maximumKernelLength)
+{
+    RealtimeSafety::checkBlockingCall ("PartitionedConvolver::prepare");
+
+    numChannels = newNumChannels;
+    partitionSize = juce::nextPowerOfTwo (newPartitionSize);
+    maxPartitions = juce::jmax (1, (maximumKernelLength + partitionSize - 1) / partitionSize);
+
+    auto fftSize = 2 * partitionSize;
+    fft = std::make_unique<juce::dsp::FFT> (getOrderForSize (fftSize));
+
+    channels.resize ((size_t) numChannels);
+
+    for (auto& state : channels)
+    {
+        state.inputFrame.assign ((size_t) fftSize, 0.0f);
+        state.output.assign ((size_t) partitionSize, 0.0f);
+        state.history.assign ((size_t) (maxPartitions * getSpectrumSize()), 0.0f);
+    }
+
+    fftBuffer.assign ((size_t) (2 * fftSize), 0.0f);
+    previousBuffer.assign ((size_t) (2 * fftSize), 0.0f);
+
+    // Whether the inverse transform divides by the FFT size depends on the
+    // FFT backend JUCE picked, so measure it with a round trip
+    fftBuffer[0] = 1.0f;
+    fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+    fft->performRealOnlyInverseTransform (fftBuffer.data());
+    inverseScale = 1.0f / fftBuffer[0];
+
+    // Old kernels were transformed for the old partition size
+    delete pendingKernel.exchange (nullptr);
+    delete retiredKernel.exchange (nullptr);
+    currentKernel.reset();
+    previousKernel.reset();
+
+    reset();
+}
+
+void PartitionedConvolver::reset() noexcept
+{
+    for (auto& state : channels)
+    {
+        std::fill (state.inputFrame.begin(), state.inputFrame.end(), 0.0f);
+        std::fill (state.output.begin(), state.output.end(), 0.0f);
+        std::fill (state.history.begin(), state.history.end(), 0.0f);
+    }
+
+    position = historyPosition = 0;
+}
+
+//==============================================================================
+std::unique_ptr<PartitionedConvolver::Kernel> PartitionedConvolver::makeKernel (const float* impulse, int length) const
+{
+    RealtimeSafety::checkBlockingCall ("PartitionedConvolver::makeKernel");
+
+    // The audio thread's FFT object isn't safe to share, so use a private one
+    auto fftSize = 2 * partitionSize;
+    juce::dsp::FFT kernelFft (getOrderForSize (fftSize));
+    std::vector<float> buffer ((size_t) (2 * fftSize));
+
+    auto kernel = std::make_unique<Kernel>();
+    length = juce::jmin (length, maxPartitions * partitionSize);
+    kernel->numPartitions = juce::jmax (1, (length + partitionSize - 1) / partitionSize);
+    kernel->spectra.resize ((size_t) (kernel->numPartitions * getSpectrumSize()));
+
+    for (int partition = 0; partition < kernel->numPartitions; ++partition)
+    {
+        auto start = partition * partitionSize;
+        auto count = juce::jlimit (0, partitionSize, length - start);
+
+        std::fill (buffer.begin(), buffer.end(), 0.0f);
+        std::copy (impulse + start, impulse + start + count, buffer.begin());
+        kernelFft.performRealOnlyForwardTransform (buffer.data(), true);
+
+        std::copy (buffer.begin(), buffer.begin() + getSpectrumSize(),
+                   kernel->spectra.begin() + partition * getSpectrumSize());
+    }
+
+    return kernel;
+}
+
+void PartitionedConvolver::setKernelNow (std::unique_ptr<Kernel> kernel)
+{
+    RealtimeSafety::checkBlockingCall ("PartitionedConvolver::setKernelNow");
+
+    delete pendingKernel.exchange (nullptr);
+    delete retiredKernel.exchange (nullptr);
+    previousKernel.reset();
+    currentKernel = std::move (kernel);
+}
+
+bool PartitionedConvolver::canQueueKernel() const noexcept
+{
+    return pendingKernel.load() == nullptr && retiredKernel.load() == nullptr;
+}
+
+bool PartitionedConvolver::queueKernel (std::unique_ptr<Kernel> kernel)
+{
+    if (! canQueueKernel())
+        return false;
+
+    pendingKernel.store (kernel.release());
+    return true;
+}
+
+void PartitionedConvolver::collectGarbage()
+{
+    RealtimeSafety::checkBlockingCall ("PartitionedConvolver::collectGarbage");
+
+    delete retiredKernel.exchange (nullptr);
+}
+
+//==============================================================================
+void PartitionedConvolver::processPartition() noexcept
+{
+    // Only start a swap once the kernel from the last one has been collected
+    if (previousKernel == nullptr && retiredKernel.load() == nullptr)
+    {
+        if (auto* next = pendingKernel.exchange (nullptr))
+        {
+            previousKernel = std::move (currentKernel);
+            currentKernel.reset (next);
+            crossfadePosition = 0;
+        }
+    }
+
+    auto spectrumSize = getSpectrumSize();
+    auto fadeLength = (float) (crossfadePartitions * partitionSize);
+
+    for (auto& state : channels)
+    {
+        std::copy (state.inputFrame.begin(), state.inputFrame.end(), fftBuffer.begin());
+        std::fill (fftBuffer.begin() + 2 * partitionSize, fftBuffer.end(), 0.0f);
+        fft->performRealOnlyForwardTransform (fftBuffer.data(), true);
+        std::copy (fftBuffer.begin(), fftBuffer.begin() + spectrumSize,
+                   state.history.begin() + historyPosition * spectrumSize);
+
+        if (currentKernel == nullptr)
+        {
+            std::fill (state.output.begin(), state.output.end(), 0.0f);
+        }
+        else
+        {
+            // Overlap-save: the second half of the circular result is the valid part
+            accumulate (*currentKernel, state, fftBuffer.data());
+            inverseTransform (fftBuffer.data());
+            std::copy (fftBuffer.data() + partitionSize, fftBuffer.data() + 2 * partitionSize, state.output.data());
+
+            if (previousKernel != nullptr)
+            {
+                accumulate (*previousKernel, state, previousBuffer.data());
+                inverseTransform (previousBuffer.data());
+
+                auto* old = previousBuffer.data() + partitionSize;
+                auto fadeStart = (float) (crossfadePosition * partitionSize);
+
+                for (int i = 0; i < partitionSize; ++i)
+                {
+                    auto gain = (fadeStart + (float) (i + 1)) / fadeLength;
+                    state.output[(size_t) i] = old[i] + (state.output[(size_t) i] - old[i]) * gain;
+                }
+            }
+        }
+
+        std::copy (state.inputFrame.begin() + partitionSize, state.inputFrame.end(), state.inputFrame.begin());
+    }
+
+    historyPosition = (historyPosition + 1) % maxPartitions;
+
+    if (previousKernel != nullptr && ++crossfadePosition == crossfadePartitions)
+        retiredKernel.store (previousKernel.release());
+}
+
+void PartitionedConvolver::accumulate (const Kernel& kernel, const ChannelState& state, float* destination) const noexcept
+{
+    auto spectrumSize = getSpectrumSize();
+    std::fill (destination, destination + spectrumSize, 0.0f);
+
+    for (int partition = 0; partition < kernel.numPartitions; ++partition)
+    {
+        auto historyIndex = (historyPosition - partition + maxPartitions) % maxPartitions;
+        auto* x = state.history.data() + historyIndex * spectrumSize;
+        auto* h = kernel.spectra.data() + partition * spectrumSize;
+
+        for (int i = 0; i < spectrumSize; i += 2)
+        {
+            destination[i]     += x[i] * h[i]     - x[i + 1] * h[i + 1];
+            destination[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+        }
+    }
+}
+
+void PartitionedConvolver::inverseTransform (float* spectrum) const noexcept
+{
+    fft->performRealOnlyInverseTransform (spectrum);
+    juce::FloatVectorOperations::multiply (spectrum, inverseScale, 2 * partitionSize);
+}
@@ -0,0 +1,130 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+
+    Uniformly-partitioned overlap-save FFT convolution with a frequency-domain
+    delay line, for any number of channels sharing one kernel.
+
+    Kernels are built off the audio thread and handed over through a pair of
+    atomic slots: the audio thread picks a new kernel up on a partition
+    boundary, crossfades from the old one and hands the old one back to be
+    freed, so it never allocates, frees or waits.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class PartitionedConvolver
+{
+public:
+    /** The spectra of a kernel's partitions, ready to be multiplied in. */
+    struct Kernel
+    {
+        int numPartitions = 0;
+        std::vector<float> spectra;    // numPartitions blocks of (partitionSize + 1) interleaved complex bins
+    };
+
+    PartitionedConvolver() = default;
+    ~PartitionedConvolver();
+
+    //==============================================================================
+    /** Allocates everything. Must not run concurrently with process(). */
+    void prepare (int numChannels, int partitionSize, int maximumKernelLength);
+
+    /** Clears the signal history and output, keeping the kernel. */
+    void reset() noexcept;
+
+    /** The delay added by buffering input into partitions. */
+    int getLatencySamples() const noexcept    { return partitionSize; }
+
+    //==============================================================================
+    /** Turns an impulse response into a Kernel. Allocates, so call it from a
+        background thread. Safe to call while the audio thread is processing.
+    */
+    std::unique_ptr<Kernel> makeKernel (const float* impulse, int length) const;
+
+    /** Installs a kernel immediately, without crossfading. Not for the audio thread. */
+    void setKernelNow (std::unique_ptr<Kernel> kernel);
+
+    /** True if a kernel passed to queueKernel() would be taken. */
+    bool canQueueKernel() const noexcept;
+
+    /** Hands a kernel to the audio thread, which crossfades to it. Call
+        collectGarbage() first; returns false (and drops the kernel) if the
+        previous swap has not finished yet.
+    */
+    bool queueKernel (std::unique_ptr<Kernel> kernel);
+
+    /** Frees a kernel the audio thread has finished with. Background thread only. */
+    void collectGarbage();
+
+    //==============================================================================
+    /** Convolves the first numChannels channels of the block in place. The
+        block may be double precision; the convolution itself runs in float.
+    */
+    template <typename SampleType>
+    void process (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        auto numSamples = (int) block.getNumSamples();
+        auto channelsToProcess = juce::jmin (numChannels, (int) block.getNumChannels());
+
+        for (int done = 0; done < numSamples;)
+        {
+            auto numToCopy = juce::jmin (partitionSize - position, numSamples - done);
+
+            for (int channel = 0; channel < channelsToProcess; ++channel)
+            {
+                auto& state = channels[(size_t) channel];
+                auto* samples = block.getChannelPointer ((size_t) channel) + done;
+
+                std::copy (samples, samples + numToCopy, state.inputFrame.data() + partitionSize + position);
+                std::copy (state.output.data() + position, state.output.data() + position + numToCopy, samples);
+            }
+
+            position += numToCopy;
+            done += numToCopy;
+
+            if (position == partitionSize)
+            {
+                processPartition();
+                position = 0;
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct ChannelState
+    {
+        std::vector<float> inputFrame;     // previous partition followed by the one being filled
+        std::vector<float> output;         // the partition currently being played out
+        std::vector<float> history;        // ring of input spectra, maxPartitions blocks
+    };
+
+    void processPartition() noexcept;
+    void accumulate (const Kernel& kernel, const ChannelState& state, float* destination) const noexcept;
+    void inverseTransform (float* spectrum) const noexcept;
+
+    int getSpectrumSize() const noexcept    { return 2 * (partitionSize + 1); }
+
+    //==============================================================================
+    static constexpr int crossfadePartitions = 8;
+
+    int numChannels = 0, partitionSize = 0, maxPartitions = 0;
+    int position = 0, historyPosition = 0, crossfadePosition = 0;
+    float inverseScale = 1.0f;
+
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<ChannelState> channels;
+    std::vector<float> fftBuffer, previousBuffer;
+
+    std::unique_ptr<Kernel> currentKernel, previousKernel;
+    std::atomic<Kernel*> pendingKernel { nullptr }, retiredKernel { nullptr };
+
+    JUCE_DECLARE_NON_COPYABLE (PartitionedConvolver)
+};
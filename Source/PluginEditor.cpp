@@ -13,9 +13,34 @@
 GraphicEqAudioProcessorEditor::GraphicEqAudioProcessorEditor (GraphicEqAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
+    addAndMakeVisible (spectrumDisplay);
+    addAndMakeVisible (parameterEditor);
+    addAndMakeVisible (loadStatus);
+    addAndMakeVisible (resetLoadButton);
+
+    if (RealtimeSafety::isEnabled)
+        addAndMakeVisible (realtimeStatus);
+
+    resetLoadButton.onClick = [this] { audioProcessor.getLoadMeter().reset(); };
+
+    for (int i = 0; i < SnapshotBank::numSnapshots; ++i)
+        snapshotSelector.addItem ("Snapshot " + SnapshotBank::getSnapshotName (i), i + 1);
+
+    snapshotSelector.setSelectedItemIndex (audioProcessor.getSnapshotBank().getCurrentSnapshot(), juce::dontSendNotification);
+    storeButton.onClick = [this] { audioProcessor.getSnapshotBank().store (snapshotSelector.getSelectedItemIndex()); };
+    recallButton.onClick = [this] { audioProcessor.getSnapshotBank().recall (snapshotSelector.getSelectedItemIndex()); };
+
+    addAndMakeVisible (snapshotSelector);
+    addAndMakeVisible (storeButton);
+    addAndMakeVisible (recallButton);
+
+    startTimerHz (4);
+    timerCallback();
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+    setSize (parameterEditor.getWidth(),
+             spectrumHeight + parameterEditor.getHeight() + statusHeight * (RealtimeSafety::isEnabled ? 3 : 2));
 }
 
 GraphicEqAudioProcessorEditor::~GraphicEqAudioProcessorEditor()
@@ -27,14 +52,53 @@ void GraphicEqAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void GraphicEqAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    auto bounds = getLocalBounds();
+
+    if (RealtimeSafety::isEnabled)
+        realtimeStatus.setBounds (bounds.removeFromBottom (statusHeight));
+
+    auto loadBounds = bounds.removeFromBottom (statusHeight);
+    resetLoadButton.setBounds (loadBounds.removeFromRight (60).reduced (2));
+    loadStatus.setBounds (loadBounds);
+
+    auto snapshotBounds = bounds.removeFromBottom (statusHeight);
+    recallButton.setBounds (snapshotBounds.removeFromRight (60).reduced (2));
+    storeButton.setBounds (snapshotBounds.removeFromRight (60).reduced (2));
+    snapshotSelector.setBounds (snapshotBounds.reduced (2));
+
+    spectrumDisplay.setBounds (bounds.removeFromTop (spectrumHeight));
+    parameterEditor.setBounds (bounds);
+}
+
+void GraphicEqAudioProcessorEditor::timerCallback()
+{
+    auto load = audioProcessor.getLoadMeter().getStatistics();
+    auto percent = [] (double fraction) { return juce::String (fraction * 100.0, 2) + "%"; };
+
+    loadStatus.setText (load.numCalls == 0 ? juce::String ("DSP load: idle")
+                                           : "DSP load p50 " + percent (load.p50) + "  p99 " + percent (load.p99)
+                                               + "  max " + percent (load.max),
+                        juce::dontSendNotification);
+
+    if (! RealtimeSafety::isEnabled)
+        return;
+
+    auto counters = RealtimeSafety::getCounters();
+
+    if (counters.getTotal() == 0)
+    {
+        realtimeStatus.setText ("Realtime safe", juce::dontSendNotification);
+        realtimeStatus.setTooltip ({});
+        return;
+    }
+
+    realtimeStatus.setText ("Realtime violations: " + juce::String (counters.allocations) + " allocations, "
+                              + juce::String (counters.deallocations) + " frees, "
+                              + juce::String (counters.blockingCalls) + " blocking calls",
+                            juce::dontSendNotification);
+    realtimeStatus.setTooltip (RealtimeSafety::getFirstViolationReport());
 }
@@ -10,11 +10,15 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumDisplay.h"
 
 //==============================================================================
-/**
+/** A pre/post EQ spectrum over the generic parameter editor, over a bar for
+    storing and recalling snapshots and a status bar showing this instance's
+    DSP load and, in builds made with GRAPHICEQ_RT_CHECKS, realtime safety.
 */
-class GraphicEqAudioProcessorEditor  : public juce::AudioProcessorEditor
+class GraphicEqAudioProcessorEditor  : public juce::AudioProcessorEditor,
+                                       private juce::Timer
 {
 public:
     GraphicEqAudioProcessorEditor (GraphicEqAudioProcessor&);
@@ -25,9 +29,22 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     GraphicEqAudioProcessor& audioProcessor;
 
+    SpectrumDisplay spectrumDisplay { audioProcessor };
+    juce::GenericAudioProcessorEditor parameterEditor { audioProcessor };
+    juce::Label loadStatus, realtimeStatus;
+    juce::TextButton resetLoadButton { "Reset" };
+
+    juce::ComboBox snapshotSelector;
+    juce::TextButton storeButton { "Store" }, recallButton { "Recall" };
+
+    static constexpr int statusHeight = 24;
+    static constexpr int spectrumHeight = 200;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphicEqAudioProcessorEditor)
 };
@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PluginState.h"
 
 //==============================================================================
 GraphicEqAudioProcessor::GraphicEqAudioProcessor()
@@ -22,10 +23,17 @@ GraphicEqAudioProcessor::GraphicEqAudioProcessor()
                        )
 #endif
 {
+    // Runs on the background thread, for when the switch happens while no blocks
+    // are being processed; processBlock reports it as soon as it switches paths
+    linearPhaseEq.onEnablementChanged = [this] { updateLatency(); };
+    linearPhaseEq.settingsSource = [this] { return getTargetSettings(); };
+    parallelEq.settingsSource = [this] { return bandCompensator.getCompensatedSettings(); };
+    backgroundThread.startThread();
 }
 
 GraphicEqAudioProcessor::~GraphicEqAudioProcessor()
 {
+    backgroundThread.stopThread(1000);
 }
 
 //==============================================================================
@@ -63,27 +71,27 @@ bool GraphicEqAudioProcessor::isMidiEffect() const
 
 double GraphicEqAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailLengthSeconds.load();
 }
 
 int GraphicEqAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    return SnapshotBank::numSnapshots;
 }
 
 int GraphicEqAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return snapshotBank.getCurrentSnapshot();
 }
 
 void GraphicEqAudioProcessor::setCurrentProgram (int index)
 {
+    snapshotBank.recall(index);
 }
 
 const juce::String GraphicEqAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return "Snapshot " + SnapshotBank::getSnapshotName(index);
 }
 
 void GraphicEqAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -96,108 +104,66 @@ void GraphicEqAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlo
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
 
-    juce::dsp::ProcessSpec spec;
-    spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
-    spec.sampleRate = sampleRate;
+    auto numChannels = juce::jlimit(1, maximumChannels, getTotalNumOutputChannels());
+    auto maximumBlockSize = samplesPerBlock * OversamplingOptions::getFactor(OversamplingOptions::numFactors - 1);
 
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    hostSampleRate = sampleRate;
+    loadMeter.prepare(sampleRate);
+    spectrumAnalyzer.prepare(sampleRate);
+    floatOversampling.prepare(numChannels, samplesPerBlock);
+    doubleOversampling.prepare(numChannels, samplesPerBlock);
 
-    auto chainSettings = getChainSettings(apvts);
+    oversamplingIndex = juce::jlimit(0, OversamplingOptions::numFactors - 1, juce::roundToInt(oversamplingParameter->load()));
+    oversamplingFilterIndex = juce::jlimit(0, OversamplingOptions::numQualities - 1, juce::roundToInt(oversamplingFilterParameter->load()));
+    oversamplingFactor = OversamplingOptions::getFactor(oversamplingIndex);
 
-    //-----------------------------------Peaks----------------------------//
+    auto* oversampler = floatOversampling.get(oversamplingIndex, oversamplingFilterIndex);
+    oversamplingLatency = oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0;
 
-    auto peak31 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        31,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak31GainInDecibels));
+    // Both precisions are always ready: the host may switch, and float I/O
+    // can run the double cascade for high precision state
+    floatCascade.prepare(sampleRate * oversamplingFactor, numChannels, maximumBlockSize);
+    doubleCascade.prepare(sampleRate * oversamplingFactor, numChannels, maximumBlockSize);
+    highPrecisionBuffer.setSize(numChannels, maximumBlockSize);
+    highPrecisionActive = highPrecisionParameter->load() >= 0.5f;
 
-    leftChain.get<ChainPositions::peak31>().coefficients = *peak31;
-    rightChain.get<ChainPositions::peak31>().coefficients = *peak31;
+    coefficientEngine.prepare(sampleRate * oversamplingFactor);
+    // The peaks are designed at the oversampled rate, so that is where their
+    // interaction has to be solved
+    bandCompensator.prepare(sampleRate * oversamplingFactor);
+    secondChannelCompensator.prepare(sampleRate * oversamplingFactor);
 
-    auto peak62 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        62,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak62GainInDecibels));
+    auto settings = getChainSettings(chainParameters);
+    bandCompensator.apply(settings);
+    activeBandMode = settings.bandMode;
 
-    leftChain.get<ChainPositions::peak62>().coefficients = *peak62;
-    rightChain.get<ChainPositions::peak62>().coefficients = *peak62;
+    auto secondSettings = getChainSettings(secondChainParameters);
+    secondChannelCompensator.apply(secondSettings);
+    activeChannelMode = static_cast<ChannelMode>(juce::jlimit(0, 2, juce::roundToInt(channelModeParameter->load())));
 
-    auto peak125 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        125,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak125GainInDecibels));
+    snapshotMorph.prepare(sampleRate * oversamplingFactor, sampleRate);
 
-    leftChain.get<ChainPositions::peak125>().coefficients = *peak125;
-    rightChain.get<ChainPositions::peak125>().coefficients = *peak125;
+    coefficientEngine.setUpdateInterval(getSmoothingInterval());
+    secondChannelIndependent = false;
+    setEngineTargets(settings, secondSettings);
 
-    auto peak250 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        250,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak250GainInDecibels));
+    stageBypass.prepare(sampleRate * oversamplingFactor);
+    stageBypass.reset(updateCoefficients());
 
-    leftChain.get<ChainPositions::peak250>().coefficients = *peak250;
-    rightChain.get<ChainPositions::peak250>().coefficients = *peak250;
+    parallelEq.prepare(sampleRate * oversamplingFactor,
+                       sampleRate * OversamplingOptions::getFactor(OversamplingOptions::numFactors - 1));
+    parallelActive = parallelEq.isEnabled() && getTotalNumInputChannels() == 1 && ! coefficientEngine.isMorphing();
+    parallelRunning = false;
 
-    auto peak500 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        500,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak500GainInDecibels));
+    linearPhaseEq.prepare(sampleRate, numChannels);
+    linearPhaseActive = linearPhaseEq.isEnabled();
 
-    leftChain.get<ChainPositions::peak500>().coefficients = *peak500;
-    rightChain.get<ChainPositions::peak500>().coefficients = *peak500;
+    // The host expects the latency to be settled once prepareToPlay returns
+    cancelPendingUpdate();
+    setLatencySamples(getEqLatency());
 
-    auto peak1k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        1000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak1kGainInDecibels));
-
-    leftChain.get<ChainPositions::peak1k>().coefficients = *peak1k;
-    rightChain.get<ChainPositions::peak1k>().coefficients = *peak1k;
-
-    auto peak2k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        2000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak2kGainInDecibels));
-
-    leftChain.get<ChainPositions::peak2k>().coefficients = *peak2k;
-    rightChain.get<ChainPositions::peak2k>().coefficients = *peak2k;
-
-    auto peak4k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        4000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak4kGainInDecibels));
-
-    leftChain.get<ChainPositions::peak4k>().coefficients = *peak4k;
-    rightChain.get<ChainPositions::peak4k>().coefficients = *peak4k;
-
-    auto peak8k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        8000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak8kGainInDecibels));
-
-    leftChain.get<ChainPositions::peak8k>().coefficients = *peak8k;
-    rightChain.get<ChainPositions::peak8k>().coefficients = *peak8k;
-
-    auto peak16k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-        16000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak16kGainInDecibels));
-
-    leftChain.get<ChainPositions::peak16k>().coefficients = *peak16k;
-    rightChain.get<ChainPositions::peak16k>().coefficients = *peak16k;
-    
-  //-------------------------------------------Filters--------------------------------------------------------//
-
-    auto Lowcut = juce::dsp::IIR::Coefficients<float>::makeHighPass(sampleRate, chainSettings.lowCutFreq, 1);
-    leftChain.get<ChainPositions::Lowcut>().coefficients = *Lowcut;
-    rightChain.get<ChainPositions::Lowcut>().coefficients = *Lowcut;
-
-    auto HiCut = juce::dsp::IIR::Coefficients<float>::makeLowPass(sampleRate, chainSettings.hiCutFreq, 1);
-    leftChain.get<ChainPositions::HiCut>().coefficients = *HiCut;
-    rightChain.get<ChainPositions::HiCut>().coefficients = *HiCut;
-    
+    silenceGate.reset();
+    updateTailLength();
 }
 
 void GraphicEqAudioProcessor::releaseResources()
@@ -213,12 +179,11 @@ bool GraphicEqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout from mono up to maximumChannels works. The channel modes
+    // pair up the first two channels; any others follow the first.
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (numChannels < 1 || numChannels > maximumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
@@ -234,7 +199,25 @@ bool GraphicEqAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts
 
 void GraphicEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
+    processBlockInternal(buffer);
+}
+
+void GraphicEqAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processBlockInternal(buffer);
+}
+
+bool GraphicEqAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+template <typename SampleType>
+void GraphicEqAudioProcessor::processBlockInternal (juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    LoadMeter::ScopedMeasurement loadMeasurement (loadMeter, buffer.getNumSamples());
     juce::ScopedNoDenormals noDenormals;
+    RealtimeSafety::ScopedRealtimeThread realtimeThread;
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -247,110 +230,437 @@ void GraphicEqAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, ju
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
    
-    //-------------------processamento dos peaks---------------------------------------//
+    //-------------------processamento dos coeficientes--------------------------------//
+
+    auto settings = getChainSettings(chainParameters);
+    bandCompensator.apply(settings);
+    coefficientEngine.setUpdateInterval(getSmoothingInterval());
+
+    auto secondSettings = getChainSettings(secondChainParameters);
+    secondChannelCompensator.apply(secondSettings);
+    auto channelMode = static_cast<ChannelMode>(juce::jlimit(0, 2, juce::roundToInt(channelModeParameter->load())));
+
+    if (channelMode != activeChannelMode)
+    {
+        // The second channel's filters now see another signal
+        resetCascades();
+        activeChannelMode = channelMode;
+    }
+
+    setEngineTargets(settings, secondSettings);
+
+    // A morph can cross band modes too, but interpolates its way across
+    if (settings.bandMode != activeBandMode && ! coefficientEngine.isMorphing())
+    {
+        // Every peak stage is retuned to another band, so the old filter state
+        // and any fades in progress are meaningless
+        resetCascades();
+        stageBypass.reset(updateCoefficients());
+        activeBandMode = settings.bandMode;
+    }
+
+    //----------------------------------------- processamento do plugin--------------//  
+    auto engine = static_cast<ProcessingEngine>(juce::roundToInt(engineParameter->load()));
+    auto linearPhase = linearPhaseEq.isEnabled();
+    auto highPrecision = highPrecisionParameter->load() >= 0.5f;
+    auto parallel = parallelEq.isEnabled() && totalNumInputChannels == 1 && ! coefficientEngine.isMorphing();
+
+    if (linearPhase != linearPhaseActive)
+    {
+        // Whichever path takes over starts from silence rather than stale history
+        linearPhaseEq.reset();
+        resetCascades();
+        linearPhaseActive = linearPhase;
+        updateLatency();
+    }
+
+    if (engine != activeEngine || highPrecision != highPrecisionActive || parallel != parallelActive)
+    {
+        // The engines and precisions keep separate filter state, so start the new one clean
+        resetCascades();
+        activeEngine = engine;
+        highPrecisionActive = highPrecision;
+        parallelActive = parallel;
+    }
+
+    setOversampling(juce::roundToInt(oversamplingParameter->load()),
+                    juce::roundToInt(oversamplingFilterParameter->load()));
+
+    auto block = juce::dsp::AudioBlock<SampleType>(buffer).getSubsetChannelBlock(0, (size_t) totalNumInputChannels);
+    auto inputIsSilent = SilenceGate::isSilent(block);
+
+    spectrumAnalyzer.push(SpectrumAnalyzer::preEq, block);
+
+    if (silenceGate.shouldSkip(inputIsSilent))
+    {
+        // Asleep on silence: nothing to filter, but keep the coefficients on
+        // the current settings so waking up doesn't ramp from stale ones
+        block.clear();
+        coefficientEngine.setUpdateInterval(0);
+        secondChannelEngine.setUpdateInterval(0);
+        stageBypass.reset(updateCoefficients());
+        updateTailLength();
+    }
+    else
+    {
+        processEq(block);
+        updateTailLength();
+
+        if (silenceGate.advance(buffer.getNumSamples(), inputIsSilent, SilenceGate::isSilent(block),
+                                tailSamples + getEqLatency()))
+        {
+            flushState();
+            block.clear();
+        }
+    }
 
-    auto chainSettings = getChainSettings(apvts);
-    auto peak31 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        31,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak31GainInDecibels));
+    spectrumAnalyzer.push(SpectrumAnalyzer::postEq, block);
+}
 
-    leftChain.get<ChainPositions::peak31>().coefficients = *peak31;
-    rightChain.get<ChainPositions::peak31>().coefficients = *peak31;
+template <typename SampleType>
+void GraphicEqAudioProcessor::processEq (juce::dsp::AudioBlock<SampleType> block) noexcept
+{
+    if (linearPhaseActive)
+    {
+        // The kernel follows the parameters from the background thread; keep the
+        // IIR coefficients current too so switching back doesn't jump
+        linearPhaseEq.process(block);
+        coefficientEngine.setUpdateInterval(0);
+        secondChannelEngine.setUpdateInterval(0);
+        stageBypass.reset(updateCoefficients());
+        return;
+    }
 
-    auto peak62 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        62,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak62GainInDecibels));
+    auto* oversampler = getOversamplingBank<SampleType>().get(oversamplingIndex, oversamplingFilterIndex);
 
-    leftChain.get<ChainPositions::peak62>().coefficients = *peak62;
-    rightChain.get<ChainPositions::peak62>().coefficients = *peak62;
+    if (oversampler == nullptr)
+    {
+        processFilters(block);
+        return;
+    }
+
+    auto oversampledBlock = oversampler->processSamplesUp(block);
+    processFilters(oversampledBlock);
+    oversampler->processSamplesDown(block);
+}
 
-    auto peak125 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        125,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak125GainInDecibels));
+template <typename SampleType>
+void GraphicEqAudioProcessor::processFilters (juce::dsp::AudioBlock<SampleType> block) noexcept
+{
+    auto numChannels = block.getNumChannels();
+    auto numSamples = (int) block.getNumSamples();
 
-    leftChain.get<ChainPositions::peak125>().coefficients = *peak125;
-    rightChain.get<ChainPositions::peak125>().coefficients = *peak125;
+    if constexpr (std::is_same<SampleType, float>::value)
+    {
+        if (highPrecisionActive)
+        {
+            // Float I/O, but the recursion and its state run in double
+            auto precisionBlock = juce::dsp::AudioBlock<double>(highPrecisionBuffer)
+                                      .getSubsetChannelBlock(0, numChannels)
+                                      .getSubBlock(0, (size_t) numSamples);
 
-    auto peak250 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        250,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak250GainInDecibels));
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                std::copy(block.getChannelPointer(channel), block.getChannelPointer(channel) + numSamples,
+                          precisionBlock.getChannelPointer(channel));
 
-    leftChain.get<ChainPositions::peak250>().coefficients = *peak250;
-    rightChain.get<ChainPositions::peak250>().coefficients = *peak250;
+            processFilters(precisionBlock);
 
-    auto peak500 = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        500,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak500GainInDecibels));
+            for (size_t channel = 0; channel < numChannels; ++channel)
+                std::copy(precisionBlock.getChannelPointer(channel), precisionBlock.getChannelPointer(channel) + numSamples,
+                          block.getChannelPointer(channel));
 
-    leftChain.get<ChainPositions::peak500>().coefficients = *peak500;
-    rightChain.get<ChainPositions::peak500>().coefficients = *peak500;
+            return;
+        }
+    }
 
-    auto peak1k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        1000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak1kGainInDecibels));
+    auto& cascade = getCascade<SampleType>();
 
-    leftChain.get<ChainPositions::peak1k>().coefficients = *peak1k;
-    rightChain.get<ChainPositions::peak1k>().coefficients = *peak1k;
+    // Mid/side stays encoded even while both channels share coefficients, so
+    // the filter state is always in the domain the mode expects
+    auto midSide = activeChannelMode == ChannelMode::midSide;
 
-    auto peak2k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        2000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak2kGainInDecibels));
+    // The parallel bank takes over the peak stages once it has a verified
+    // expansion for this rate; the cuts stay in the cascade in front of it
+    constexpr auto peakStages = ((CoefficientEngine::StageMask (1) << maxPeakBands) - 1) << ChainPositions::firstPeak;
+    auto parallel = parallelActive && parallelEq.isReady();
 
-    leftChain.get<ChainPositions::peak2k>().coefficients = *peak2k;
-    rightChain.get<ChainPositions::peak2k>().coefficients = *peak2k;
+    if (parallel != parallelRunning)
+    {
+        // Only what sat idle holds stale state: the bank taking over, or the
+        // peak stages going back into the cascade, which fade in from clean
+        // the way a stage leaving neutral does. The cuts run either way.
+        if (parallel)
+        {
+            parallelEq.reset();
+        }
+        else
+        {
+            cascade.resetStages(peakStages);
+            stageBypass.restartStages(peakStages);
+        }
+
+        parallelRunning = parallel;
+    }
 
-    auto peak4k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        4000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak4kGainInDecibels));
+    for (int start = 0; start < numSamples;)
+    {
+        stageBypass.setNeutralStages(updateCoefficients());
 
-    leftChain.get<ChainPositions::peak4k>().coefficients = *peak4k;
-    rightChain.get<ChainPositions::peak4k>().coefficients = *peak4k;
+        auto subBlockSize = coefficientEngine.getSamplesUntilUpdate(numSamples - start);
 
-    auto peak8k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        8000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak8kGainInDecibels));
+        if (secondChannelIndependent)
+            subBlockSize = secondChannelEngine.getSamplesUntilUpdate(subBlockSize);
 
-    leftChain.get<ChainPositions::peak8k>().coefficients = *peak8k;
-    rightChain.get<ChainPositions::peak8k>().coefficients = *peak8k;
+        auto subBlock = block.getSubBlock((size_t) start, (size_t) subBlockSize);
 
-    auto peak16k = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-        16000,
-        0.707,
-        juce::Decibels::decibelsToGain(chainSettings.peak16kGainInDecibels));
+        if (parallel)
+        {
+            cascade.process(subBlock, activeEngine == ProcessingEngine::simd, stageBypass.withoutStages(peakStages));
+            parallelEq.process(subBlock);
+        }
+        else
+        {
+            cascade.process(subBlock, activeEngine == ProcessingEngine::simd, stageBypass, midSide);
+        }
 
-    leftChain.get<ChainPositions::peak16k>().coefficients = *peak16k;
-    rightChain.get<ChainPositions::peak16k>().coefficients = *peak16k;
-    
-    //--------------------prcoessamento dos filtros-------------------------------------//
+        if (auto fadedOut = stageBypass.advance(subBlockSize))
+            cascade.resetStages(fadedOut);
 
-    auto Lowcut = juce::dsp::IIR::Coefficients<float>::makeHighPass(getSampleRate(), chainSettings.lowCutFreq, 1);
+        coefficientEngine.advance(subBlockSize);
 
-    leftChain.get<ChainPositions::Lowcut>().coefficients = *Lowcut;
-    rightChain.get<ChainPositions::Lowcut>().coefficients = *Lowcut;
+        if (secondChannelIndependent)
+            secondChannelEngine.advance(subBlockSize);
 
-    auto HiCut = juce::dsp::IIR::Coefficients<float>::makeLowPass(getSampleRate(), chainSettings.hiCutFreq, 1);
-    leftChain.get<ChainPositions::HiCut>().coefficients = *HiCut;
-    rightChain.get<ChainPositions::HiCut>().coefficients = *HiCut;
+        start += subBlockSize;
+    }
+}
 
+void GraphicEqAudioProcessor::resetCascades() noexcept
+{
+    floatCascade.reset();
+    doubleCascade.reset();
+    parallelEq.reset();
+}
 
-    //----------------------------------------- processamento do plugin--------------//  
-    juce::dsp::AudioBlock<float> block(buffer);
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+int GraphicEqAudioProcessor::getSmoothingInterval() const noexcept
+{
+    constexpr int intervals[] = { 0, 16, 32, 64 };
+    return intervals[juce::jlimit(0, 3, juce::roundToInt(smoothingParameter->load()))] * oversamplingFactor;
+}
+
+CoefficientEngine::StageMask GraphicEqAudioProcessor::updateCoefficients() noexcept
+{
+    auto changedStages = coefficientEngine.update();
+
+    if (! secondChannelIndependent)
+    {
+        publishCoefficients(changedStages);
+        return coefficientEngine.getNeutralStages();
+    }
+
+    changedStages |= secondChannelEngine.update();
+
+    // A stage can only be skipped once it is neutral on both channels; until
+    // then the channel it is neutral on runs it as a straight wire, so every
+    // change of either neutral set has to be published too
+    auto neutralStages = coefficientEngine.getNeutralStages();
+    auto secondNeutralStages = secondChannelEngine.getNeutralStages();
+    changedStages |= (neutralStages ^ publishedNeutralStages) | (secondNeutralStages ^ publishedSecondNeutralStages);
+    publishedNeutralStages = neutralStages;
+    publishedSecondNeutralStages = secondNeutralStages;
+
+    publishCoefficients(changedStages);
+    return neutralStages & secondNeutralStages;
+}
+
+void GraphicEqAudioProcessor::publishCoefficients (CoefficientEngine::StageMask changedStages) noexcept
+{
+    const BiquadCoefficients<double> wire;
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+    {
+        auto bit = CoefficientEngine::StageMask (1) << stage;
+
+        if ((changedStages & bit) == 0)
+            continue;
+
+        if (! secondChannelIndependent)
+        {
+            auto& coefficients = coefficientEngine.getStage (stage);
+            floatCascade.setStageCoefficients (stage, coefficients);
+            doubleCascade.setStageCoefficients (stage, coefficients);
+            continue;
+        }
+
+        auto& coefficients = (publishedNeutralStages & bit) != 0 ? wire : coefficientEngine.getStage (stage);
+        auto& secondCoefficients = (publishedSecondNeutralStages & bit) != 0 ? wire : secondChannelEngine.getStage (stage);
+
+        floatCascade.setStageCoefficients (stage, coefficients);
+        doubleCascade.setStageCoefficients (stage, coefficients);
+        floatCascade.setSecondChannelStageCoefficients (stage, secondCoefficients);
+        doubleCascade.setSecondChannelStageCoefficients (stage, secondCoefficients);
+    }
+}
+
+void GraphicEqAudioProcessor::setEngineTargets (const ChainSettings& settings, const ChainSettings& secondSettings) noexcept
+{
+    auto morph = snapshotMorph.isEnabled();
+
+    if (auto* endpoints = morph ? snapshotMorph.getEndpoints() : nullptr)
+    {
+        setMorphTargets(*endpoints);
+        return;
+    }
 
+    // A morph in progress holds still for the few milliseconds it takes the
+    // background thread to design a new pair of snapshots
+    if (morph && coefficientEngine.isMorphing())
+        return;
+
+    coefficientEngine.setTargets(settings);
+    setSecondChannelTargets(settings, secondSettings);
+}
+
+void GraphicEqAudioProcessor::setSecondChannelTargets (const ChainSettings& settings, const ChainSettings& secondSettings) noexcept
+{
+    if (updateSecondChannelIndependence(secondSettings != settings))
+        secondChannelEngine.setTargets(secondSettings);
+}
+
+void GraphicEqAudioProcessor::setMorphTargets (const SnapshotMorph::Endpoints& endpoints) noexcept
+{
+    auto position = juce::jlimit(0.0f, 1.0f, snapshotMorph.getPosition());
+    coefficientEngine.setMorphTargets(endpoints.sets[0][0], endpoints.sets[0][1], endpoints.versions[0], position);
+
+    auto channelsDiffer = endpoints.settings[1][0] != endpoints.settings[0][0]
+                       || endpoints.settings[1][1] != endpoints.settings[0][1];
+
+    if (updateSecondChannelIndependence(channelsDiffer))
+        secondChannelEngine.setMorphTargets(endpoints.sets[1][0], endpoints.sets[1][1], endpoints.versions[1], position);
+}
+
+bool GraphicEqAudioProcessor::updateSecondChannelIndependence (bool channelsDiffer) noexcept
+{
+    // Stay independent until a ramp back to matching settings has finished on
+    // both sides, so handing back never jumps
+    auto independent = activeChannelMode != ChannelMode::linked
+                    && getTotalNumInputChannels() > 1
+                    && (channelsDiffer
+                        || (secondChannelIndependent && (secondChannelEngine.isRamping() || coefficientEngine.isRamping())));
+
+    if (independent && ! secondChannelIndependent)
+    {
+        // Start from exactly where the shared coefficients are, so the second
+        // channel ramps away from them rather than jumping
+        secondChannelEngine = coefficientEngine;
+        publishedNeutralStages = publishedSecondNeutralStages = coefficientEngine.getNeutralStages();
+    }
+
+    if (! independent && secondChannelIndependent)
+    {
+        // Back to shared: undo any straight wires and the second channel's own designs
+        secondChannelIndependent = false;
+        publishCoefficients(CoefficientEngine::allStages);
+    }
+
+    secondChannelIndependent = independent;
+
+    if (independent)
+        secondChannelEngine.setUpdateInterval(coefficientEngine.getUpdateInterval());
+
+    return independent;
+}
+
+void GraphicEqAudioProcessor::setOversampling (int factorIndex, int qualityIndex) noexcept
+{
+    factorIndex = juce::jlimit(0, OversamplingOptions::numFactors - 1, factorIndex);
+    qualityIndex = juce::jlimit(0, OversamplingOptions::numQualities - 1, qualityIndex);
+
+    if (factorIndex == oversamplingIndex && qualityIndex == oversamplingFilterIndex)
+        return;
+
+    oversamplingIndex = factorIndex;
+    oversamplingFilterIndex = qualityIndex;
+    oversamplingFactor = OversamplingOptions::getFactor(factorIndex);
+
+    auto* oversampler = floatOversampling.get(factorIndex, qualityIndex);
+    oversamplingLatency = oversampler != nullptr ? juce::roundToInt(oversampler->getLatencyInSamples()) : 0;
+
+    floatOversampling.reset(factorIndex, qualityIndex);
+    doubleOversampling.reset(factorIndex, qualityIndex);
+
+    // Every stage gets redesigned for the new rate, so old filter state is meaningless
+    resetCascades();
+
+    coefficientEngine.prepare(hostSampleRate * oversamplingFactor);
+    coefficientEngine.setUpdateInterval(getSmoothingInterval());
+    stageBypass.prepare(hostSampleRate * oversamplingFactor);
+    parallelEq.setSampleRate(hostSampleRate * oversamplingFactor);
+    bandCompensator.setSampleRate(hostSampleRate * oversamplingFactor);
+    secondChannelCompensator.setSampleRate(hostSampleRate * oversamplingFactor);
+    snapshotMorph.setSampleRate(hostSampleRate * oversamplingFactor);
+
+    // The next block copies the freshly prepared engine again if the channels still differ
+    secondChannelIndependent = false;
+
+    updateLatency();
+}
+
+ChainSettings GraphicEqAudioProcessor::getTargetSettings()
+{
+    return snapshotMorph.isEnabled() ? snapshotMorph.getMorphedSettings() : bandCompensator.getCompensatedSettings();
+}
+
+double GraphicEqAudioProcessor::getFilterSampleRate() const noexcept
+{
+    auto factorIndex = juce::jlimit(0, OversamplingOptions::numFactors - 1, juce::roundToInt(oversamplingParameter->load()));
+    auto sampleRate = getSampleRate() > 0.0 ? getSampleRate() : 44100.0;
+
+    return sampleRate * OversamplingOptions::getFactor(factorIndex);
+}
+
+int GraphicEqAudioProcessor::getEqLatency() const noexcept
+{
+    return linearPhaseEq.isEnabled() ? linearPhaseEq.getLatencySamples() : oversamplingLatency.load();
+}
+
+void GraphicEqAudioProcessor::updateLatency() noexcept
+{
+    triggerAsyncUpdate();
+}
+
+void GraphicEqAudioProcessor::handleAsyncUpdate()
+{
+    setLatencySamples(getEqLatency());
+}
+
+void GraphicEqAudioProcessor::updateTailLength() noexcept
+{
+    if (linearPhaseActive)
+    {
+        // The kernel is symmetric about the latency it is compensated for
+        tailSamples = LinearPhaseEq::getKernelLength(hostSampleRate) / 2;
+    }
+    else
+    {
+        auto cascadeSamples = coefficientEngine.getTailSamples();
+
+        if (secondChannelIndependent)
+            cascadeSamples = juce::jmax(cascadeSamples, secondChannelEngine.getTailSamples());
+
+        tailSamples = cascadeSamples / oversamplingFactor;
+    }
+
+    tailSamples = juce::jmin(tailSamples, maximumTailSeconds * hostSampleRate);
+    tailLengthSeconds = tailSamples / hostSampleRate;
+}
+
+void GraphicEqAudioProcessor::flushState() noexcept
+{
+    resetCascades();
+    linearPhaseEq.reset();
+    floatOversampling.reset(oversamplingIndex, oversamplingFilterIndex);
+    doubleOversampling.reset(oversamplingIndex, oversamplingFilterIndex);
 }
 
 //==============================================================================
@@ -361,8 +671,7 @@ bool GraphicEqAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* GraphicEqAudioProcessor::createEditor()
 {
-    //return new GraphicEqAudioProcessorEditor (*this); 
-    return new juce::GenericAudioProcessorEditor(*this);
+    return new GraphicEqAudioProcessorEditor (*this);
 }
 
 //==============================================================================
@@ -371,16 +680,24 @@ void GraphicEqAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
+    RealtimeSafety::checkBlockingCall("getStateInformation");
 
-    juce::MemoryOutputStream mos(destData, true);
-    apvts.state.writeToStream(mos);
+    PluginState::write(apvts, snapshotBank, destData);
 }
 
 void GraphicEqAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+    RealtimeSafety::checkBlockingCall("setStateInformation");
 
+    if (PluginState::isBinaryState(data, sizeInBytes))
+    {
+        PluginState::read(apvts, snapshotBank, data, sizeInBytes);
+        return;
+    }
+
+    // Sessions saved before the binary format hold the whole ValueTree
     auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
     if (tree.isValid())
     {
@@ -388,24 +705,50 @@ void GraphicEqAudioProcessor::setStateInformation (const void* data, int sizeInB
     }
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts, const juce::String& idSuffix)
+    : ChainParameters([&apvts] (const juce::String& parameterID) { return apvts.getRawParameterValue(parameterID); }, idSuffix)
 {
-    ChainSettings settings;
+}
+
+ChainParameters::ChainParameters(const Lookup& lookup, const juce::String& idSuffix)
+    : lowCutFreq(lookup("LowCut" + idSuffix)),
+      hiCutFreq(lookup("HiCut" + idSuffix)),
+      bandMode(lookup("BandMode")),
+      lowCutSlope(lookup("LowCutSlope" + idSuffix)),
+      hiCutSlope(lookup("HiCutSlope" + idSuffix)),
+      lowCutType(lookup("LowCutType" + idSuffix)),
+      hiCutType(lookup("HiCutType" + idSuffix))
+{
+    for (int band = 0; band < numOctaveBands; ++band)
+        octaveGains[(size_t) band] = lookup(octaveBands[band].parameterID + idSuffix);
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut")->load();
-    settings.hiCutFreq = apvts.getRawParameterValue("HiCut")->load();
+    for (int band = 0; band < numThirdOctaveBands; ++band)
+        thirdOctaveGains[(size_t) band] = lookup(thirdOctaveBands[band].parameterID + idSuffix);
+}
 
-    settings.peak31GainInDecibels = apvts.getRawParameterValue("peak31")->load();
-    settings.peak62GainInDecibels = apvts.getRawParameterValue("peak62")->load();
-    settings.peak125GainInDecibels = apvts.getRawParameterValue("peak125")->load();
-    settings.peak250GainInDecibels = apvts.getRawParameterValue("peak250")->load();
-    settings.peak500GainInDecibels = apvts.getRawParameterValue("peak500")->load();
-    settings.peak1kGainInDecibels = apvts.getRawParameterValue("peak1k")->load();
-    settings.peak2kGainInDecibels = apvts.getRawParameterValue("peak2k")->load();
-    settings.peak4kGainInDecibels = apvts.getRawParameterValue("peak4k")->load();
-    settings.peak8kGainInDecibels = apvts.getRawParameterValue("peak8k")->load();
-    settings.peak16kGainInDecibels = apvts.getRawParameterValue("peak16k")->load();
+ChainSettings getChainSettings(const ChainParameters& parameters)
+{
+    ChainSettings settings;
 
+    settings.lowCutFreq = parameters.lowCutFreq->load();
+    settings.hiCutFreq = parameters.hiCutFreq->load();
+    settings.bandMode = static_cast<BandMode>(juce::jlimit(0, 1, juce::roundToInt(parameters.bandMode->load())));
+    settings.lowCutSections = juce::jlimit(1, maxCutSections, juce::roundToInt(parameters.lowCutSlope->load()) + 1);
+    settings.hiCutSections = juce::jlimit(1, maxCutSections, juce::roundToInt(parameters.hiCutSlope->load()) + 1);
+    settings.lowCutType = static_cast<CutType>(juce::jlimit(0, 2, juce::roundToInt(parameters.lowCutType->load())));
+    settings.hiCutType = static_cast<CutType>(juce::jlimit(0, 2, juce::roundToInt(parameters.hiCutType->load())));
+
+    // Only the active table's gains are copied, the remaining stages stay neutral
+    if (settings.bandMode == BandMode::thirdOctave)
+    {
+        for (size_t band = 0; band < parameters.thirdOctaveGains.size(); ++band)
+            settings.peakGainInDecibels[band] = parameters.thirdOctaveGains[band]->load();
+    }
+    else
+    {
+        for (size_t band = 0; band < parameters.octaveGains.size(); ++band)
+            settings.peakGainInDecibels[band] = parameters.octaveGains[band]->load();
+    }
 
     return settings;
 }
@@ -421,54 +764,123 @@ juce::AudioProcessorValueTreeState::ParameterLayout
                                                            "Low Pass",
                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
                                                            20000.f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak31",
-                                                           "31 Hz",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak62",
-                                                           "62 Hz",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak125",
-                                                           "125 Hz",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak250",
-                                                           "250 Hz",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak500",
-                                                           "500 Hz",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak1k",
-                                                           "1 kHz",
-                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                            0.0f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak2k",
-                                                           "2 kHz",
-                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                            0.0f));
-    
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak4k",
-                                                           "4 kHz",
-                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                            0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak8k",
-                                                           "8 kHz",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                           0.0f));
-    layout.add(std::make_unique<juce::AudioParameterFloat>("peak16k",
-                                                           "16 kHz",
-                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+    for (auto& band : octaveBands)
+        layout.add(std::make_unique<juce::AudioParameterFloat>(band.parameterID,
+                                                               band.name,
+                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                               0.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Engine",
+                                                            "Engine",
+                                                            juce::StringArray { "Scalar", "SIMD" },
+                                                            static_cast<int>(ProcessingEngine::simd)));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Smoothing",
+                                                            "Smoothing",
+                                                            juce::StringArray { "Off", "16 samples", "32 samples", "64 samples" },
+                                                            2));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("LinearPhase",
+                                                          "Linear Phase",
+                                                          false));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling",
+                                                            "Oversampling",
+                                                            OversamplingOptions::getFactorNames(),
+                                                            0));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("OversamplingFilter",
+                                                            "Oversampling Filter",
+                                                            OversamplingOptions::getQualityNames(),
+                                                            static_cast<int>(OversamplingOptions::Quality::polyphaseIIR)));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("HighPrecision",
+                                                          "High Precision State",
+                                                          false));
+
+    // Added after the original parameters so hosts that address parameters by
+    // index keep finding them where they were
+    layout.add(std::make_unique<juce::AudioParameterChoice>("BandMode",
+                                                            "Bands",
+                                                            juce::StringArray { "10-band octave", "31-band third-octave" },
+                                                            static_cast<int>(BandMode::octave)));
+
+    for (auto& band : thirdOctaveBands)
+        layout.add(std::make_unique<juce::AudioParameterFloat>(band.parameterID,
+                                                               band.name,
+                                                               juce::NormalisableRange<float>(-12.f, 12.f, 0.5f, 1.f),
+                                                               0.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("Compensation",
+                                                          "Band Compensation",
+                                                          false));
+
+    // One 12 dB/oct section per step, see maxCutSections
+    juce::StringArray slopeNames { "12 dB/oct", "24 dB/oct", "36 dB/oct", "48 dB/oct" };
+    juce::StringArray cutTypeNames { "Original (Q 1)", "Butterworth", "Linkwitz-Riley" };
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCutSlope", "High Pass Slope", slopeNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCutType", "High Pass Type", cutTypeNames,
+                                                            static_cast<int>(CutType::original)));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HiCutSlope", "Low Pass Slope", slopeNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HiCutType", "Low Pass Type", cutTypeNames,
+                                                            static_cast<int>(CutType::original)));
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("ChannelMode",
+                                                            "Channels",
+                                                            juce::StringArray { "Stereo (linked)", "Left / Right", "Mid / Side" },
+                                                            static_cast<int>(ChannelMode::linked)));
+
+    // Everything but the band mode again for the right or side channel, only
+    // heard when the channels aren't linked
+    juce::String suffix (ChainParameters::secondChannelSuffix);
+    juce::String prefix ("R/S ");
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut" + suffix,
+                                                           prefix + "High Pass",
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                           20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("HiCut" + suffix,
+                                                           prefix + "Low Pass",
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                           20000.f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCutSlope" + suffix, prefix + "High Pass Slope", slopeNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCutType" + suffix, prefix + "High Pass Type", cutTypeNames,
+                                                            static_cast<int>(CutType::original)));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HiCutSlope" + suffix, prefix + "Low Pass Slope", slopeNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HiCutType" + suffix, prefix + "Low Pass Type", cutTypeNames,
+                                                            static_cast<int>(CutType::original)));
+
+    for (auto& band : octaveBands)
+        layout.add(std::make_unique<juce::AudioParameterFloat>(band.parameterID + suffix,
+                                                               prefix + band.name,
+                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                               0.0f));
+
+    for (auto& band : thirdOctaveBands)
+        layout.add(std::make_unique<juce::AudioParameterFloat>(band.parameterID + suffix,
+                                                               prefix + band.name,
+                                                               juce::NormalisableRange<float>(-12.f, 12.f, 0.5f, 1.f),
+                                                               0.0f));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("Parallel",
+                                                          "Parallel Bands (Mono)",
+                                                          false));
+
+    juce::StringArray snapshotNames;
+
+    for (int i = 0; i < SnapshotBank::numSnapshots; ++i)
+        snapshotNames.add(SnapshotBank::getSnapshotName(i));
+
+    layout.add(std::make_unique<juce::AudioParameterBool>("MorphEnabled",
+                                                          "Snapshot Morph",
+                                                          false));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("MorphFrom", "Morph From", snapshotNames, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("MorphTo", "Morph To", snapshotNames, 1));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Morph",
+                                                           "Morph",
+                                                           juce::NormalisableRange<float>(0.f, 1.f),
                                                            0.0f));
 
     return layout;
@@ -9,25 +9,23 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BandCompensator.h"
+#include "CoefficientEngine.h"
+#include "EqCascade.h"
+#include "LinearPhaseEq.h"
+#include "LoadMeter.h"
+#include "OversamplingBank.h"
+#include "ParallelEq.h"
+#include "RealtimeSafety.h"
+#include "SilenceGate.h"
+#include "SnapshotMorph.h"
+#include "SpectrumAnalyzer.h"
 
-
-struct ChainSettings
-{
-    float  peak31GainInDecibels{ 0 }, peak62GainInDecibels{ 0 },
-           peak125GainInDecibels{ 0 }, peak250GainInDecibels{ 0 },
-           peak500GainInDecibels{ 0 },peak1kGainInDecibels{ 0 },
-           peak2kGainInDecibels{ 0 }, peak4kGainInDecibels{ 0 },
-           peak8kGainInDecibels{ 0 }, peak16kGainInDecibels{ 0 };
-          
-    float lowCutFreq{ 0 }, hiCutFreq{ 0 };
-
-
-};
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
 //==============================================================================
 /**
 */
-class GraphicEqAudioProcessor  : public juce::AudioProcessor
+class GraphicEqAudioProcessor  : public juce::AudioProcessor,
+                                 private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -43,6 +41,8 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -68,32 +68,203 @@ public:
     void setStateInformation (const void* data, int sizeInBytes) override;
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", createParameterLayout()};
-  
-private:
 
-    using Filter = juce::dsp::IIR::Filter<float>;
-    using CutFilter = juce::dsp::ProcessorChain<Filter>;
-    using MonoChain = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter, Filter, Filter, Filter,
-        Filter, Filter, Filter, Filter, Filter>;
+    /** Per-call processBlock cost relative to the block's real-time budget. */
+    LoadMeter& getLoadMeter() noexcept    { return loadMeter; }
+
+    /** The pre/post EQ spectrum, analysed on the background thread. */
+    SpectrumAnalyzer& getSpectrumAnalyzer() noexcept    { return spectrumAnalyzer; }
 
-    MonoChain leftChain, rightChain;
+    const ChainParameters& getChainParameters() const noexcept    { return chainParameters; }
 
-    enum ChainPositions
+    /** Solves the interaction-compensated band gains when that mode is on. */
+    BandCompensator& getBandCompensator() noexcept    { return bandCompensator; }
+
+    /** The parallel form of the peak bands, for mono instances. */
+    ParallelEq& getParallelEq() noexcept    { return parallelEq; }
+
+    /** The snapshots A to H, which are also the plugin's programs. */
+    SnapshotBank& getSnapshotBank() noexcept    { return snapshotBank; }
+
+    /** The settings the first channel is heading for: the morph's current
+        point while morphing, otherwise the parameters, compensated if that is
+        on. Solves or designs on the spot; not for the audio thread. */
+    ChainSettings getTargetSettings();
+
+    /** The rate the IIR stages are designed for, including oversampling, so the
+        editor can draw the response the cascade really has. Safe to call from
+        any thread. */
+    double getFilterSampleRate() const noexcept;
+
+    /** How the cascade is run: the reference per-channel filter chains, or
+        all channels at once through the SIMD kernel. */
+    enum class ProcessingEngine
     {
-        Lowcut,
-        peak31,
-        peak62,
-        peak125,
-        peak250,
-        peak500,
-        peak1k,
-        peak2k,
-        peak4k,
-        peak8k,
-        peak16k,
-        HiCut
+        scalar,
+        simd
     };
 
+    /** How the first two channels are equalised: both by the first channel's
+        settings, or left and right, or mid and side, each by their own. */
+    enum class ChannelMode
+    {
+        linked,
+        leftRight,
+        midSide
+    };
+
+private:
+
+    /** Widest supported bus: 7.1.4 needs 12, leave room for 16. */
+    static constexpr int maximumChannels = 16;
+
+    /** The shared body of both processBlock overloads. */
+    template <typename SampleType>
+    void processBlockInternal (juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    /** Runs whichever of linear phase or the (possibly oversampled) IIR
+        cascade is active over the block. */
+    template <typename SampleType>
+    void processEq (juce::dsp::AudioBlock<SampleType> block) noexcept;
+
+    /** Runs the IIR cascade over a block at the processing rate, splitting it
+        wherever a ramping stage is due for new coefficients. */
+    template <typename SampleType>
+    void processFilters (juce::dsp::AudioBlock<SampleType> block) noexcept;
+
+    template <typename SampleType>
+    EqCascade<SampleType>& getCascade() noexcept
+    {
+        if constexpr (std::is_same<SampleType, float>::value)
+            return floatCascade;
+        else
+            return doubleCascade;
+    }
+
+    template <typename SampleType>
+    OversamplingBank<SampleType>& getOversamplingBank() noexcept
+    {
+        if constexpr (std::is_same<SampleType, float>::value)
+            return floatOversampling;
+        else
+            return doubleOversampling;
+    }
+
+    /** Clears the filter state of both cascades and the parallel banks. */
+    void resetCascades() noexcept;
+
+    /** Samples between coefficient updates while a setting ramps, or 0 for no smoothing. */
+    int getSmoothingInterval() const noexcept;
+
+    /** Steps the coefficient engines, writes whatever changed into the cascades
+        and returns the stages that can be skipped. */
+    CoefficientEngine::StageMask updateCoefficients() noexcept;
+
+    /** Writes the redesigned stages into both cascades. */
+    void publishCoefficients (CoefficientEngine::StageMask changedStages) noexcept;
+
+    /** Points the coefficient engines at the parameters' settings or, while
+        morphing, at the snapshot morph's endpoints. */
+    void setEngineTargets (const ChainSettings& settings, const ChainSettings& secondSettings) noexcept;
+
+    /** Gives the second channel an engine of its own while its settings differ
+        from the first channel's, and hands it back once they match again. */
+    void setSecondChannelTargets (const ChainSettings& settings, const ChainSettings& secondSettings) noexcept;
+    void setMorphTargets (const SnapshotMorph::Endpoints& endpoints) noexcept;
+
+    /** Decides whether the second channel needs its own engine, returning true
+        if it does. Shared by both of the above. */
+    bool updateSecondChannelIndependence (bool channelsDiffer) noexcept;
+
+    /** Switches the cascade to another oversampling factor or filter and
+        redesigns it for the new rate. Allocation-free, called from processBlock;
+        the new latency reaches the host through updateLatency(). */
+    void setOversampling (int factorIndex, int qualityIndex) noexcept;
+
+    /** The delay of whichever of linear phase or oversampling is active. */
+    int getEqLatency() const noexcept;
+
+    /** Has the current delay reported to the host from the message thread,
+        since setLatencySamples() isn't safe from processBlock. */
+    void updateLatency() noexcept;
+    void handleAsyncUpdate() override;
+
+    /** Works out how long the active EQ rings for from its current
+        coefficients, for the host and the silence gate. */
+    void updateTailLength() noexcept;
+
+    /** Clears every filter and delay line, when the silence gate goes to sleep. */
+    void flushState() noexcept;
+
+    ChainParameters chainParameters { apvts };
+    SnapshotBank snapshotBank { apvts };
+    CoefficientEngine coefficientEngine;
+
+    /** The right or side channel's settings. Its engine only runs while they
+        differ from the first channel's; otherwise the first engine's
+        coefficients go to every channel. */
+    ChainParameters secondChainParameters { apvts, ChainParameters::secondChannelSuffix };
+    CoefficientEngine secondChannelEngine;
+    std::atomic<float>* channelModeParameter = apvts.getRawParameterValue("ChannelMode");
+    ChannelMode activeChannelMode = ChannelMode::linked;
+    bool secondChannelIndependent = false;
+    CoefficientEngine::StageMask publishedNeutralStages = 0, publishedSecondNeutralStages = 0;
+
+    /** Float I/O normally runs the float cascade; double I/O, or float I/O with
+        high precision state, runs the double one. */
+    EqCascade<float> floatCascade;
+    EqCascade<double> doubleCascade;
+    StageBypass stageBypass;
+
+    std::atomic<float>* engineParameter = apvts.getRawParameterValue("Engine");
+    std::atomic<float>* smoothingParameter = apvts.getRawParameterValue("Smoothing");
+    ProcessingEngine activeEngine = ProcessingEngine::simd;
+    BandMode activeBandMode = BandMode::octave;
+
+    std::atomic<float>* highPrecisionParameter = apvts.getRawParameterValue("HighPrecision");
+    juce::AudioBuffer<double> highPrecisionBuffer;
+    bool highPrecisionActive = false;
+
+    /** Solves band compensation, redesigns the linear-phase kernel, designs
+        morph endpoints and analyses the spectrum off the audio thread. */
+    juce::TimeSliceThread backgroundThread { "GraphicEq background" };
+    BandCompensator bandCompensator { chainParameters, apvts.getRawParameterValue("Compensation"), backgroundThread };
+    BandCompensator secondChannelCompensator { secondChainParameters, apvts.getRawParameterValue("Compensation"), backgroundThread };
+    LinearPhaseEq linearPhaseEq { chainParameters, apvts.getRawParameterValue("LinearPhase"), backgroundThread };
+    bool linearPhaseActive = false;
+
+    /** Mono instances can run the peak bands as parallel sections instead;
+        parallelRunning is whether the last block actually did, as it falls
+        back to the cascade while no verified expansion is ready. */
+    ParallelEq parallelEq { chainParameters, apvts.getRawParameterValue("Parallel"), backgroundThread };
+    bool parallelActive = false, parallelRunning = false;
+
+    /** Designs both ends of a snapshot morph, so the audio thread only
+        interpolates coefficients while the morph control moves. */
+    SnapshotMorph snapshotMorph { snapshotBank, apvts, backgroundThread };
+
+    SpectrumAnalyzer spectrumAnalyzer { backgroundThread };
+
+    /** Oversamplers for every factor and filter are built in prepareToPlay, so
+        changing either parameter never allocates on the audio thread. */
+    OversamplingBank<float> floatOversampling;
+    OversamplingBank<double> doubleOversampling;
+    std::atomic<float>* oversamplingParameter = apvts.getRawParameterValue("Oversampling");
+    std::atomic<float>* oversamplingFilterParameter = apvts.getRawParameterValue("OversamplingFilter");
+    int oversamplingIndex = 0, oversamplingFilterIndex = 0, oversamplingFactor = 1;
+    std::atomic<int> oversamplingLatency { 0 };
+    double hostSampleRate = 44100.0;
+
+    LoadMeter loadMeter;
+
+    /** Longest tail reported to the host, so a badly tuned extreme setting
+        can't ask it to keep us running for ever. */
+    static constexpr double maximumTailSeconds = 10.0;
+
+    SilenceGate silenceGate;
+    double tailSamples = 0.0;    // at the host rate
+    std::atomic<double> tailLengthSeconds { 0.0 };
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphicEqAudioProcessor)
 };
@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    PluginState.cpp
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+#include "SnapshotBank.h"
+
+namespace
+{
+    const auto magic = (juce::uint32) juce::ByteOrder::littleEndianInt ("GEQS");
+
+    /** 32-bit FNV-1a, enough to catch a truncated or corrupted state. */
+    juce::uint32 hashBytes (const void* data, size_t numBytes, juce::uint32 hash = 2166136261u) noexcept
+    {
+        auto* bytes = static_cast<const juce::uint8*> (data);
+
+        for (size_t i = 0; i < numBytes; ++i)
+            hash = (hash ^ bytes[i]) * 16777619u;
+
+        return hash;
+    }
+
+    juce::uint32 hashParameterIDs (const juce::Array<juce::RangedAudioParameter*>& parameters, int numParameters)
+    {
+        auto hash = hashBytes (nullptr, 0);
+
+        for (int i = 0; i < numParameters; ++i)
+        {
+            auto& id = parameters.getUnchecked (i)->paramID;
+            hash = hashBytes (id.toRawUTF8(), id.getNumBytesAsUTF8() + 1, hash);    // including the terminator
+        }
+
+        return hash;
+    }
+}
+
+//==============================================================================
+void PluginState::write (juce::AudioProcessorValueTreeState& apvts, const SnapshotBank& snapshots, juce::MemoryBlock& destData)
+{
+    auto parameters = getStateParameters (apvts);
+    auto numParameters = parameters.size();
+
+    juce::MemoryOutputStream values ((size_t) (numParameters * (1 + SnapshotBank::numSnapshots) + 1) * sizeof (float));
+
+    for (auto* parameter : parameters)
+        values.writeFloat (parameter->convertFrom0to1 (parameter->getValue()));
+
+    values.writeShort ((short) SnapshotBank::numSnapshots);
+    values.writeShort ((short) snapshots.getCurrentSnapshot());
+
+    for (int snapshot = 0; snapshot < SnapshotBank::numSnapshots; ++snapshot)
+        for (int i = 0; i < numParameters; ++i)
+            values.writeFloat (snapshots.getValue (snapshot, i));
+
+    juce::MemoryOutputStream stream (destData, false);
+    stream.writeInt ((int) magic);
+    stream.writeShort ((short) currentVersion);
+    stream.writeShort ((short) numParameters);
+    stream.writeInt ((int) hashParameterIDs (parameters, numParameters));
+    stream.writeInt ((int) hashBytes (values.getData(), values.getDataSize()));
+    stream.write (values.getData(), values.getDataSize());
+}
+
+bool PluginState::read (juce::AudioProcessorValueTreeState& apvts, SnapshotBank& snapshots, const void* data, int sizeInBytes)
+{
+    if (! isBinaryState (data, sizeInBytes))
+        return false;
+
+    juce::MemoryInputStream stream (data, (size_t) sizeInBytes, false);
+    stream.skipNextBytes (4);
+
+    auto version = (int) (juce::uint16) stream.readShort();
+    auto numStored = (int) (juce::uint16) stream.readShort();
+    auto idHash = (juce::uint32) stream.readInt();
+    auto checksum = (juce::uint32) stream.readInt();
+
+    auto parameters = getStateParameters (apvts);
+    auto valuesSize = (size_t) numStored * sizeof (float);
+    auto payloadSize = (size_t) sizeInBytes - (size_t) headerSize;
+
+    // A newer build's state may hold parameters this one doesn't know about
+    if (version > currentVersion || numStored > parameters.size())
+        return false;
+
+    auto* payload = static_cast<const char*> (data) + headerSize;
+    auto numSnapshots = 0, currentSnapshot = 0;
+
+    if (version >= 2)
+    {
+        if (payloadSize < valuesSize + 4)
+            return false;
+
+        auto* snapshotHeader = payload + valuesSize;
+        numSnapshots = (int) juce::ByteOrder::littleEndianShort (snapshotHeader);
+        currentSnapshot = (int) juce::ByteOrder::littleEndianShort (snapshotHeader + 2);
+
+        if (payloadSize != valuesSize + 4 + (size_t) numSnapshots * valuesSize)
+            return false;
+    }
+    else if (payloadSize != valuesSize)
+    {
+        return false;
+    }
+
+    if (hashBytes (payload, payloadSize) != checksum || hashParameterIDs (parameters, numStored) != idHash)
+        return false;
+
+    juce::MemoryInputStream values (payload, payloadSize, false);
+
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto* parameter = parameters.getUnchecked (i);
+        auto normalised = parameter->getDefaultValue();
+
+        if (i < numStored)
+        {
+            auto value = values.readFloat();
+
+            if (std::isfinite (value))
+                normalised = parameter->convertTo0to1 (value);
+        }
+
+        // Only what actually moves goes out to listeners and the host
+        if (normalised != parameter->getValue())
+            parameter->setValueNotifyingHost (normalised);
+    }
+
+    if (numSnapshots > 0)
+    {
+        values.skipNextBytes (4);
+        std::vector<float> snapshotValues ((size_t) numStored);
+
+        // Snapshots this build has no room for are dropped
+        for (int snapshot = 0; snapshot < numSnapshots; ++snapshot)
+        {
+            for (auto& value : snapshotValues)
+                value = values.readFloat();
+
+            if (snapshot < SnapshotBank::numSnapshots)
+                snapshots.setValues (snapshot, snapshotValues.data(), numStored);
+        }
+
+        snapshots.setCurrentSnapshot (currentSnapshot);
+    }
+
+    return true;
+}
+
+juce::Array<juce::RangedAudioParameter*> PluginState::getStateParameters (juce::AudioProcessorValueTreeState& apvts)
+{
+    juce::Array<juce::RangedAudioParameter*> parameters;
+
+    for (auto* parameter : apvts.processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter))
+            parameters.add (ranged);
+
+    return parameters;
+}
+
+bool PluginState::isBinaryState (const void* data, int sizeInBytes) noexcept
+{
+    return data != nullptr && sizeInBytes >= headerSize
+        && juce::ByteOrder::littleEndianInt (data) == magic;
+}
@@ -0,0 +1,62 @@
+/*
+  ==============================================================================
+
+    PluginState.h
+
+    The plugin's saved state: a small header followed by every parameter's
+    value, in the order the parameters were added, as raw little-endian floats.
+
+        offset  size  field
+        0       4     magic, "GEQS"
+        4       2     format version
+        6       2     number of parameters stored
+        8       4     hash of the stored parameters' IDs, in order
+        12      4     checksum of everything after the header
+        16      4n    the values, in each parameter's own units
+
+    From version 2 the snapshots follow, each a copy of every parameter:
+
+        16+4n   2     number of snapshots stored, k
+        18+4n   2     the current snapshot
+        20+4n   4nk   the snapshots' values, one after the other
+
+    Parameters are only ever appended, so a state from an older build is a
+    prefix of the current layout; the ID hash makes sure of that before any
+    value is trusted, and parameters it doesn't cover go back to default.
+    A version 1 state leaves the snapshots as they are.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class SnapshotBank;
+
+//==============================================================================
+namespace PluginState
+{
+    constexpr int currentVersion = 2;
+    constexpr int headerSize = 16;
+
+    /** Writes the current parameter values and the snapshots. */
+    void write (juce::AudioProcessorValueTreeState& apvts, const SnapshotBank& snapshots, juce::MemoryBlock& destData);
+
+    /** Restores a state written by write(), returning false, and leaving the
+        parameters alone, if the data isn't one that can be read safely.
+
+        Parameters that already hold the stored value are skipped, so
+        recalling a session only notifies listeners and the host of the
+        parameters that actually move, and no ValueTree is built on the way;
+        the APVTS mirrors the new values into its tree by itself.
+    */
+    bool read (juce::AudioProcessorValueTreeState& apvts, SnapshotBank& snapshots, const void* data, int sizeInBytes);
+
+    /** True if the data starts like a state written by write(), rather than
+        the ValueTree the plugin used to save. */
+    bool isBinaryState (const void* data, int sizeInBytes) noexcept;
+
+    /** The parameters that make up the state, in the order they were added. */
+    juce::Array<juce::RangedAudioParameter*> getStateParameters (juce::AudioProcessorValueTreeState& apvts);
+}
@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeSafety.h"
+
+#if GRAPHICEQ_RT_CHECKS
+
+#include <new>
+
+namespace
+{
+    enum class Violation
+    {
+        allocation,
+        deallocation,
+        blockingCall
+    };
+
+    thread_local bool realtimeThread = false;
+    thread_local bool insideReport = false;
+    thread_local juce::int64 threadAllocations = 0;
+
+    std::atomic<juce::int64> allocations { 0 }, deallocations { 0 }, blockingCalls { 0 };
+    std::atomic<bool> hasReport { false };
+
+    juce::SpinLock& getReportLock()
+    {
+        static juce::SpinLock lock;
+        return lock;
+    }
+
+    juce::String& getReport()
+    {
+        static juce::String report;
+        return report;
+    }
+
+    void reportViolation (Violation violation, const char* name) noexcept
+    {
+        // Building the report allocates, which mustn't count or land back in here
+        if (insideReport)
+            return;
+
+        switch (violation)
+        {
+            case Violation::allocation:    ++allocations;   break;
+            case Violation::deallocation:  ++deallocations; break;
+            case Violation::blockingCall:  ++blockingCalls; break;
+            default:                       break;
+        }
+
+        if (hasReport.exchange (true))
+            return;
+
+        insideReport = true;
+
+        {
+            auto report = juce::String (name) + " on the audio thread\n" + juce::SystemStats::getStackBacktrace();
+
+            const juce::SpinLock::ScopedLockType sl (getReportLock());
+            getReport() = report;
+        }
+
+        insideReport = false;
+    }
+
+    void* allocate (std::size_t size)
+    {
+        ++threadAllocations;
+
+        if (realtimeThread)
+            reportViolation (Violation::allocation, "operator new");
+
+        if (auto* p = std::malloc (size == 0 ? 1 : size))
+            return p;
+
+        throw std::bad_alloc();
+    }
+
+    void* allocateAligned (std::size_t size, std::align_val_t alignment)
+    {
+        ++threadAllocations;
+
+        if (realtimeThread)
+            reportViolation (Violation::allocation, "operator new");
+
+        size = juce::jmax ((std::size_t) 1, size);
+
+       #if JUCE_WINDOWS
+        if (auto* p = _aligned_malloc (size, (std::size_t) alignment))
+            return p;
+       #else
+        void* p = nullptr;
+
+        if (posix_memalign (&p, juce::jmax (sizeof (void*), (std::size_t) alignment), size) == 0)
+            return p;
+       #endif
+
+        throw std::bad_alloc();
+    }
+
+    void deallocate (void* p) noexcept
+    {
+        if (p != nullptr && realtimeThread)
+            reportViolation (Violation::deallocation, "operator delete");
+
+        std::free (p);
+    }
+
+    void deallocateAligned (void* p) noexcept
+    {
+        if (p != nullptr && realtimeThread)
+            reportViolation (Violation::deallocation, "operator delete");
+
+       #if JUCE_WINDOWS
+        _aligned_free (p);
+       #else
+        std::free (p);
+       #endif
+    }
+}
+
+//==============================================================================
+RealtimeSafety::ScopedRealtimeThread::ScopedRealtimeThread() noexcept
+    : wasRealtime (realtimeThread)
+{
+    realtimeThread = true;
+}
+
+RealtimeSafety::ScopedRealtimeThread::~ScopedRealtimeThread() noexcept
+{
+    realtimeThread = wasRealtime;
+}
+
+bool RealtimeSafety::isRealtimeThread() noexcept
+{
+    return realtimeThread;
+}
+
+void RealtimeSafety::checkBlockingCall (const char* name) noexcept
+{
+    if (realtimeThread)
+        reportViolation (Violation::blockingCall, name);
+}
+
+RealtimeSafety::Counters RealtimeSafety::getCounters() noexcept
+{
+    return { allocations.load(), deallocations.load(), blockingCalls.load() };
+}
+
+void RealtimeSafety::resetCounters() noexcept
+{
+    allocations = 0;
+    deallocations = 0;
+    blockingCalls = 0;
+    hasReport = false;
+}
+
+juce::String RealtimeSafety::getFirstViolationReport()
+{
+    const juce::SpinLock::ScopedLockType sl (getReportLock());
+    return getReport();
+}
+
+juce::int64 RealtimeSafety::getThreadAllocationCount() noexcept
+{
+    return threadAllocations;
+}
+
+//==============================================================================
+void* operator new (std::size_t size)                                     { return allocate (size); }
+void* operator new[] (std::size_t size)                                   { return allocate (size); }
+void* operator new (std::size_t size, std::align_val_t alignment)         { return allocateAligned (size, alignment); }
+void* operator new[] (std::size_t size, std::align_val_t alignment)       { return allocateAligned (size, alignment); }
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate (size); } catch (...) { return nullptr; }
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept
+{
+    try { return allocate (size); } catch (...) { return nullptr; }
+}
+
+void operator delete (void* p) noexcept                                   { deallocate (p); }
+void operator delete[] (void* p) noexcept                                 { deallocate (p); }
+void operator delete (void* p, std::size_t) noexcept                      { deallocate (p); }
+void operator delete[] (void* p, std::size_t) noexcept                    { deallocate (p); }
+void operator delete (void* p, std::align_val_t) noexcept                 { deallocateAligned (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept               { deallocateAligned (p); }
+void operator delete (void* p, std::size_t, std::align_val_t) noexcept    { deallocateAligned (p); }
+void operator delete[] (void* p, std::size_t, std::align_val_t) noexcept  { deallocateAligned (p); }
+
+#endif
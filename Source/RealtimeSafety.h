@@ -0,0 +1,87 @@
+/*
+  ==============================================================================
+
+    RealtimeSafety.h
+
+    Opt-in instrumentation for the audio callback. Build with
+    GRAPHICEQ_RT_CHECKS=1 and every heap allocation, deallocation or known
+    blocking call made while a thread is tagged as realtime is counted, and
+    the first one is kept with a stack trace.
+
+    Allocations are caught by replacing the global operator new/delete.
+    Blocking calls are the places in this code base that take locks, wait or
+    build large objects; they announce themselves with checkBlockingCall().
+    Locks taken inside JUCE or the host are not seen.
+
+    With checks off everything here compiles to nothing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef GRAPHICEQ_RT_CHECKS
+ #define GRAPHICEQ_RT_CHECKS 0
+#endif
+
+//==============================================================================
+namespace RealtimeSafety
+{
+    struct Counters
+    {
+        juce::int64 allocations = 0, deallocations = 0, blockingCalls = 0;
+
+        juce::int64 getTotal() const noexcept    { return allocations + deallocations + blockingCalls; }
+    };
+
+   #if GRAPHICEQ_RT_CHECKS
+    constexpr bool isEnabled = true;
+
+    /** Tags the calling thread as realtime for the lifetime of the object. */
+    class ScopedRealtimeThread
+    {
+    public:
+        ScopedRealtimeThread() noexcept;
+        ~ScopedRealtimeThread() noexcept;
+
+    private:
+        bool wasRealtime;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeThread)
+    };
+
+    bool isRealtimeThread() noexcept;
+
+    /** Call at the top of anything that may lock, wait or allocate. */
+    void checkBlockingCall (const char* name) noexcept;
+
+    /** Violations across all threads since the last resetCounters(). */
+    Counters getCounters() noexcept;
+    void resetCounters() noexcept;
+
+    /** What the first violation was and where it came from, or empty. Not for
+        the audio thread.
+    */
+    juce::String getFirstViolationReport();
+
+    /** Every allocation made by the calling thread, realtime or not. */
+    juce::int64 getThreadAllocationCount() noexcept;
+   #else
+    constexpr bool isEnabled = false;
+
+    class ScopedRealtimeThread
+    {
+    public:
+        ScopedRealtimeThread() noexcept {}
+    };
+
+    inline bool isRealtimeThread() noexcept                  { return false; }
+    inline void checkBlockingCall (const char*) noexcept     {}
+    inline Counters getCounters() noexcept                   { return {}; }
+    inline void resetCounters() noexcept                     {}
+    inline juce::String getFirstViolationReport()            { return {}; }
+    inline juce::int64 getThreadAllocationCount() noexcept   { return 0; }
+   #endif
+}
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+
+//==============================================================================
+ResponseCurve::ResponseCurve()
+{
+    for (auto& decibels : stageDecibels)
+        decibels.assign ((size_t) numPoints, 0.0f);
+
+    stageValues.fill (std::numeric_limits<float>::quiet_NaN());
+    total.assign ((size_t) numPoints, 0.0f);
+    path.preallocateSpace (3 * numPoints);
+}
+
+bool ResponseCurve::update (const ChainSettings& settings, double newSampleRate)
+{
+    if (newSampleRate != sampleRate)
+        setSampleRate (newSampleRate);
+
+    // Another band table or cut slope retunes stages whose values may not move
+    if (! settings.hasSameLayout (layout))
+    {
+        layout = settings;
+        stageValues.fill (std::numeric_limits<float>::quiet_NaN());
+    }
+
+    auto changed = false;
+
+    for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+    {
+        auto value = settings.getStageValue (stage);
+
+        // Also true for the NaN the values start out as
+        if (! (value == stageValues[(size_t) stage]))
+        {
+            evaluateStage (stage, value);
+            changed = true;
+        }
+    }
+
+    if (! changed)
+        return false;
+
+    std::fill (total.begin(), total.end(), 0.0f);
+
+    for (auto& decibels : stageDecibels)
+        std::transform (total.begin(), total.end(), decibels.begin(), total.begin(), std::plus<float>());
+
+    rebuildPath();
+    return true;
+}
+
+//==============================================================================
+void ResponseCurve::setSampleRate (double newSampleRate)
+{
+    sampleRate = newSampleRate;
+    zInverse.clear();
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto frequency = juce::mapToLog10 ((double) i / (numPoints - 1), minimumFrequency, maximumFrequency);
+
+        if (frequency >= sampleRate * 0.5)
+            break;
+
+        zInverse.push_back (std::polar (1.0, -juce::MathConstants<double>::twoPi * frequency / sampleRate));
+    }
+
+    // Every stage has to be designed again for the new rate
+    stageValues.fill (std::numeric_limits<float>::quiet_NaN());
+}
+
+void ResponseCurve::evaluateStage (int stage, float value)
+{
+    stageValues[(size_t) stage] = value;
+    auto& decibels = stageDecibels[(size_t) stage];
+
+    // Neutral stages are skipped by the cascade, so they are flat
+    if (ChainSettings::isStageValueNeutral (stage, value))
+    {
+        std::fill (decibels.begin(), decibels.end(), 0.0f);
+        return;
+    }
+
+    auto coefficients = CoefficientEngine::designStage (sampleRate, layout, stage, value);
+
+    for (size_t i = 0; i < zInverse.size(); ++i)
+        decibels[i] = juce::Decibels::gainToDecibels ((float) coefficients.getMagnitude (zInverse[i]), -200.0f);
+}
+
+void ResponseCurve::rebuildPath()
+{
+    path.clear();
+
+    for (size_t i = 0; i < zInverse.size(); ++i)
+    {
+        auto x = (float) i / (numPoints - 1);
+        auto y = juce::jmap (juce::jlimit (-rangeDecibels, rangeDecibels, total[i]), -rangeDecibels, rangeDecibels, 1.0f, 0.0f);
+
+        if (i == 0)
+            path.startNewSubPath (x, y);
+        else
+            path.lineTo (x, y);
+    }
+}
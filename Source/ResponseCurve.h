@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+
+    The combined magnitude response of the cascade on a fixed log-frequency
+    grid, for drawing. Each stage's response is cached, and only the stages
+    whose setting changed are evaluated again, so dragging one band costs one
+    biquad over the grid however many bands there are or however wide the
+    display is.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "CoefficientEngine.h"
+
+//==============================================================================
+class ResponseCurve
+{
+public:
+    ResponseCurve();
+
+    /** Brings the curve up to date with new settings, re-evaluating only the
+        stages that changed. Returns true if the curve moved.
+    */
+    bool update (const ChainSettings& settings, double sampleRate);
+
+    /** The curve in a unit square: x runs from minimumFrequency to
+        maximumFrequency on a log scale, y from +rangeDecibels down to
+        -rangeDecibels.
+    */
+    const juce::Path& getPath() const noexcept    { return path; }
+
+    /** The combined response in dB at each grid point. */
+    const std::vector<float>& getDecibels() const noexcept    { return total; }
+
+    static constexpr int numPoints = 512;
+    static constexpr double minimumFrequency = 20.0, maximumFrequency = 20000.0;
+    static constexpr float rangeDecibels = 30.0f;
+
+private:
+    void setSampleRate (double newSampleRate);
+    void evaluateStage (int stage, float value);
+    void rebuildPath();
+
+    double sampleRate = 0.0;
+    ChainSettings layout;
+    std::vector<std::complex<double>> zInverse;    // e^-jw at each grid point below Nyquist
+
+    std::array<std::vector<float>, ChainPositions::numChainStages> stageDecibels;
+    std::array<float, ChainPositions::numChainStages> stageValues;
+    std::vector<float> total;
+    juce::Path path;
+};
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    SilenceGate.h
+
+    Puts the EQ to sleep on silent input. Once the input has been silent for
+    longer than the filters ring for, and the output has died away too, the
+    caller flushes its filter state and stops processing, writing silence
+    instead, until a block with signal in it arrives.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class SilenceGate
+{
+public:
+    /** Anything quieter than this counts as silence: -120 dBFS. */
+    static constexpr float silenceThreshold = 1.0e-6f;
+
+    template <typename SampleType>
+    static bool isSilent (const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        auto range = block.findMinAndMax();
+        return juce::jmax (-range.getStart(), range.getEnd()) < (SampleType) silenceThreshold;
+    }
+
+    //==============================================================================
+    /** Wakes up and starts counting silence from scratch. */
+    void reset() noexcept
+    {
+        asleep = false;
+        silentSamples = 0.0;
+    }
+
+    bool isAsleep() const noexcept    { return asleep; }
+
+    /** Call before processing a block. True if it can be skipped: the gate is
+        asleep and the input still silent. Signal in the input wakes it.
+    */
+    bool shouldSkip (bool inputIsSilent) noexcept
+    {
+        if (asleep && ! inputIsSilent)
+            reset();
+
+        return asleep;
+    }
+
+    /** Call after processing a block, with how long the EQ could still be
+        producing output from what it has already seen: its ringing plus any
+        latency. Returns true if the gate has just gone to sleep, when the
+        caller should clear its filter state.
+    */
+    bool advance (int numSamples, bool inputWasSilent, bool outputWasSilent, double tailSamples) noexcept
+    {
+        silentSamples = inputWasSilent ? silentSamples + numSamples : 0.0;
+        asleep = silentSamples > tailSamples && outputWasSilent;
+
+        return asleep;
+    }
+
+private:
+    bool asleep = false;
+    double silentSamples = 0.0;
+};
@@ -0,0 +1,255 @@
+/*
+  ==============================================================================
+
+    SimdBiquadCascade.h
+
+    A cascade of transposed direct form II biquads that runs several channels
+    at once, one channel per lane of a juce::dsp::SIMDRegister. Each block is
+    interleaved into a scratch buffer of registers, pushed through every stage
+    in turn, and de-interleaved back into the channels. For mid/side
+    processing the first two channels are encoded on the way in and decoded
+    on the way out, so M/S costs no extra pass over the block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BiquadDesign.h"
+#include "StageBypass.h"
+
+//==============================================================================
+template <typename SampleType>
+class SimdBiquadCascade
+{
+public:
+    using Vector = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int numLanes = (int) Vector::size();
+
+    static_assert (numLanes >= 2, "Mid/side needs both channels of a pair in one register");
+
+    //==============================================================================
+    /** Allocates state for numChannels and numStages. Call before processing,
+        never from the audio thread.
+    */
+    void prepare (int numChannels, int numStages, int maximumBlockSize)
+    {
+        channels = numChannels;
+        stages = numStages;
+        groups = (numChannels + numLanes - 1) / numLanes;
+
+        coefficients.assign ((size_t) (groups * stages), {});
+        state.assign ((size_t) (groups * stages), {});
+        scratch.assign ((size_t) juce::jmax (1, maximumBlockSize), {});
+
+        for (int stage = 0; stage < stages; ++stage)
+            setStageCoefficients (stage, BiquadCoefficients<double>());
+    }
+
+    void reset() noexcept
+    {
+        std::fill (state.begin(), state.end(), StageState());
+    }
+
+    /** Clears the state of one stage in every channel. */
+    void resetStage (int stage) noexcept
+    {
+        for (int group = 0; group < groups; ++group)
+            getState (group, stage) = StageState();
+    }
+
+    int getNumChannels() const noexcept    { return channels; }
+
+    //==============================================================================
+    /** Loads the same coefficients into every lane of a stage. */
+    void setStageCoefficients (int stage, const BiquadCoefficients<double>& newCoefficients) noexcept
+    {
+        auto c = newCoefficients.cast<SampleType>();
+
+        for (int group = 0; group < groups; ++group)
+        {
+            auto& target = getCoefficients (group, stage);
+            target.b0 = Vector::expand (c.b0);
+            target.b1 = Vector::expand (c.b1);
+            target.b2 = Vector::expand (c.b2);
+            target.a1 = Vector::expand (c.a1);
+            target.a2 = Vector::expand (c.a2);
+        }
+    }
+
+    /** Loads coefficients into the lane of one channel only. */
+    void setStageCoefficients (int stage, int channel, const BiquadCoefficients<double>& newCoefficients) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (channel, channels));
+
+        auto c = newCoefficients.cast<SampleType>();
+        auto& target = getCoefficients (channel / numLanes, stage);
+        auto lane = (size_t) (channel % numLanes);
+
+        target.b0.set (lane, c.b0);
+        target.b1.set (lane, c.b1);
+        target.b2.set (lane, c.b2);
+        target.a1.set (lane, c.a1);
+        target.a2.set (lane, c.a2);
+    }
+
+    //==============================================================================
+    /** Filters the first getNumChannels() channels of the block in place,
+        skipping or crossfading stages as the StageBypass says. With midSide
+        set, lanes 0 and 1 filter the mid and side of the first two channels.
+    */
+    void process (const juce::dsp::AudioBlock<SampleType>& block, const StageBypass& bypass, bool midSide = false) noexcept
+    {
+        auto numChannels = juce::jmin (channels, (int) block.getNumChannels());
+        auto numSamples = (int) block.getNumSamples();
+        auto chunkSize = (int) scratch.size();
+
+        for (int start = 0; start < numSamples; start += chunkSize)
+        {
+            auto chunk = juce::jmin (chunkSize, numSamples - start);
+
+            for (int group = 0; group * numLanes < numChannels; ++group)
+            {
+                SampleType* lanes[numLanes] = {};
+
+                for (int lane = 0; lane < numLanes; ++lane)
+                {
+                    auto channel = group * numLanes + lane;
+
+                    if (channel < numChannels)
+                        lanes[lane] = block.getChannelPointer ((size_t) channel) + start;
+                }
+
+                auto encode = midSide && group == 0 && lanes[0] != nullptr && lanes[1] != nullptr;
+                interleave (lanes, chunk, encode);
+
+                for (int stage = 0; stage < stages; ++stage)
+                {
+                    if (! bypass.isProcessed (stage))
+                        continue;
+
+                    if (bypass.isFading (stage))
+                        processFadingStage (getCoefficients (group, stage), getState (group, stage),
+                                            bypass.getFade (stage), start, chunk);
+                    else
+                        processStage (getCoefficients (group, stage), getState (group, stage), chunk);
+                }
+
+                deinterleave (lanes, chunk, encode);
+            }
+        }
+    }
+
+private:
+    //==============================================================================
+    struct StageCoefficients
+    {
+        Vector b0, b1, b2, a1, a2;
+    };
+
+    struct StageState
+    {
+        Vector s1 { Vector::expand (0) }, s2 { Vector::expand (0) };
+    };
+
+    StageCoefficients& getCoefficients (int group, int stage) noexcept    { return coefficients[(size_t) (group * stages + stage)]; }
+    StageState& getState (int group, int stage) noexcept                  { return state[(size_t) (group * stages + stage)]; }
+
+    void interleave (SampleType* const* lanes, int numSamples, bool midSide) noexcept
+    {
+        auto* raw = reinterpret_cast<SampleType*> (scratch.data());
+        auto firstLane = 0;
+
+        if (midSide)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                raw[i * numLanes]     = (SampleType) 0.5 * (lanes[0][i] + lanes[1][i]);
+                raw[i * numLanes + 1] = (SampleType) 0.5 * (lanes[0][i] - lanes[1][i]);
+            }
+
+            firstLane = 2;
+        }
+
+        for (int lane = firstLane; lane < numLanes; ++lane)
+        {
+            if (auto* source = lanes[lane])
+                for (int i = 0; i < numSamples; ++i)
+                    raw[i * numLanes + lane] = source[i];
+            else
+                for (int i = 0; i < numSamples; ++i)
+                    raw[i * numLanes + lane] = 0;
+        }
+    }
+
+    void deinterleave (SampleType* const* lanes, int numSamples, bool midSide) const noexcept
+    {
+        auto* raw = reinterpret_cast<const SampleType*> (scratch.data());
+        auto firstLane = 0;
+
+        if (midSide)
+        {
+            for (int i = 0; i < numSamples; ++i)
+            {
+                lanes[0][i] = raw[i * numLanes] + raw[i * numLanes + 1];
+                lanes[1][i] = raw[i * numLanes] - raw[i * numLanes + 1];
+            }
+
+            firstLane = 2;
+        }
+
+        for (int lane = firstLane; lane < numLanes; ++lane)
+            if (auto* destination = lanes[lane])
+                for (int i = 0; i < numSamples; ++i)
+                    destination[i] = raw[i * numLanes + lane];
+    }
+
+    void processStage (const StageCoefficients& c, StageState& st, int numSamples) noexcept
+    {
+        auto s1 = st.s1, s2 = st.s2;
+        auto* samples = scratch.data();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = samples[i];
+            auto output = (c.b0 * input) + s1;
+            s1 = (c.b1 * input) - (c.a1 * output) + s2;
+            s2 = (c.b2 * input) - (c.a2 * output);
+            samples[i] = output;
+        }
+
+        st.s1 = s1;
+        st.s2 = s2;
+    }
+
+    /** As processStage(), but blends the filter output with its input; the
+        filter state still runs on the unblended output. fadeOffset is where
+        this chunk starts within the block the Fade was taken for.
+    */
+    void processFadingStage (const StageCoefficients& c, StageState& st,
+                             StageBypass::Fade fade, int fadeOffset, int numSamples) noexcept
+    {
+        auto s1 = st.s1, s2 = st.s2;
+        auto* samples = scratch.data();
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto input = samples[i];
+            auto output = (c.b0 * input) + s1;
+            s1 = (c.b1 * input) - (c.a1 * output) + s2;
+            s2 = (c.b2 * input) - (c.a2 * output);
+            samples[i] = input + (output - input) * (SampleType) fade.getGain (fadeOffset + i);
+        }
+
+        st.s1 = s1;
+        st.s2 = s2;
+    }
+
+    //==============================================================================
+    int channels = 0, stages = 0, groups = 0;
+
+    std::vector<StageCoefficients> coefficients;
+    std::vector<StageState> state;
+    std::vector<Vector> scratch;
+};
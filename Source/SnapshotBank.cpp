@@ -0,0 +1,101 @@
+/*
+  ==============================================================================
+
+    SnapshotBank.cpp
+
+  ==============================================================================
+*/
+
+#include "SnapshotBank.h"
+#include "PluginState.h"
+
+//==============================================================================
+SnapshotBank::SnapshotBank (juce::AudioProcessorValueTreeState& apvts)
+    : parameters (PluginState::getStateParameters (apvts))
+{
+    std::map<juce::String, int> indices;
+
+    for (int i = 0; i < parameters.size(); ++i)
+        indices[parameters.getUnchecked (i)->paramID] = i;
+
+    for (auto& snapshot : snapshots)
+    {
+        snapshot.values.reset (new std::atomic<float>[(size_t) parameters.size()]);
+
+        for (int i = 0; i < parameters.size(); ++i)
+            snapshot.values[(size_t) i] = parameters.getUnchecked (i)->convertFrom0to1 (parameters.getUnchecked (i)->getValue());
+
+        // Whatever ChainParameters looks up is what shapes the curve
+        auto lookup = [this, &indices, &snapshot] (const juce::String& parameterID)
+        {
+            auto index = indices.at (parameterID);
+            curveParameters.addIfNotAlreadyThere (index);
+            return &snapshot.values[(size_t) index];
+        };
+
+        snapshot.chainParameters = std::make_unique<ChainParameters> (lookup);
+        snapshot.secondChainParameters = std::make_unique<ChainParameters> (lookup, ChainParameters::secondChannelSuffix);
+    }
+}
+
+juce::String SnapshotBank::getSnapshotName (int index)
+{
+    return juce::String::charToString ((juce::juce_wchar) ('A' + index));
+}
+
+//==============================================================================
+void SnapshotBank::store (int index)
+{
+    auto& snapshot = snapshots[(size_t) juce::jlimit (0, numSnapshots - 1, index)];
+
+    for (int i = 0; i < parameters.size(); ++i)
+        snapshot.values[(size_t) i] = parameters.getUnchecked (i)->convertFrom0to1 (parameters.getUnchecked (i)->getValue());
+
+    setCurrentSnapshot (index);
+    ++version;
+}
+
+void SnapshotBank::recall (int index)
+{
+    setCurrentSnapshot (index);
+    auto& snapshot = snapshots[(size_t) currentSnapshot.load()];
+
+    for (auto i : curveParameters)
+    {
+        auto* parameter = parameters.getUnchecked (i);
+        auto normalised = parameter->convertTo0to1 (snapshot.values[(size_t) i].load());
+
+        if (normalised != parameter->getValue())
+            parameter->setValueNotifyingHost (normalised);
+    }
+}
+
+const ChainParameters& SnapshotBank::getChainParameters (int index, int channel) const noexcept
+{
+    auto& snapshot = snapshots[(size_t) juce::jlimit (0, numSnapshots - 1, index)];
+    return channel == 0 ? *snapshot.chainParameters : *snapshot.secondChainParameters;
+}
+
+//==============================================================================
+float SnapshotBank::getValue (int index, int parameterIndex) const noexcept
+{
+    return snapshots[(size_t) index].values[(size_t) parameterIndex].load();
+}
+
+void SnapshotBank::setValues (int index, const float* values, int numValues) noexcept
+{
+    auto& snapshot = snapshots[(size_t) index];
+
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto* parameter = parameters.getUnchecked (i);
+        auto value = i < numValues ? values[i] : 0.0f;
+
+        if (i >= numValues || ! std::isfinite (value))
+            value = parameter->convertFrom0to1 (parameter->getDefaultValue());
+
+        snapshot.values[(size_t) i] = parameter->convertFrom0to1 (parameter->convertTo0to1 (value));
+    }
+
+    ++version;
+}
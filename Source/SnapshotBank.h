@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    SnapshotBank.h
+
+    In-memory snapshots of the plugin's settings, A to H. Each holds a copy of
+    every parameter in the saved state, so it can be written out with it, but
+    recalling one only moves the parameters that shape the curve: the bands,
+    the cuts and the band mode, for both channels. The rest, like the engine
+    or the morph controls themselves, stay where they are.
+
+    Every snapshot can also be read as a ChainParameters, so anything that
+    designs from parameters can design from a snapshot without recalling it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "EqBands.h"
+
+//==============================================================================
+class SnapshotBank
+{
+public:
+    static constexpr int numSnapshots = 8;
+
+    /** Starts with every snapshot holding the parameters' current values. */
+    explicit SnapshotBank (juce::AudioProcessorValueTreeState& apvts);
+
+    /** "A" to "H". */
+    static juce::String getSnapshotName (int index);
+
+    //==============================================================================
+    /** Copies the current parameter values into a snapshot. Message thread only. */
+    void store (int index);
+
+    /** Moves the curve parameters to a snapshot's values, notifying the host of
+        the ones that change. Message thread only.
+    */
+    void recall (int index);
+
+    /** The snapshot last stored or recalled. */
+    int getCurrentSnapshot() const noexcept    { return currentSnapshot; }
+    void setCurrentSnapshot (int index) noexcept    { currentSnapshot = juce::jlimit (0, numSnapshots - 1, index); }
+
+    /** A snapshot's settings for the first channel or, with channel 1, the second's. */
+    const ChainParameters& getChainParameters (int index, int channel) const noexcept;
+
+    /** Counts up whenever the contents of any snapshot change. */
+    juce::uint32 getVersion() const noexcept    { return version.load(); }
+
+    //==============================================================================
+    /** Values in the order of PluginState::getStateParameters(), in each
+        parameter's own units. */
+    int getNumValues() const noexcept    { return parameters.size(); }
+    float getValue (int index, int parameterIndex) const noexcept;
+
+    /** Replaces a snapshot with saved values; parameters past numValues go
+        back to their defaults, as do values that aren't finite. */
+    void setValues (int index, const float* values, int numValues) noexcept;
+
+private:
+    //==============================================================================
+    struct Snapshot
+    {
+        std::unique_ptr<std::atomic<float>[]> values;
+        std::unique_ptr<ChainParameters> chainParameters, secondChainParameters;
+    };
+
+    juce::Array<juce::RangedAudioParameter*> parameters;
+    juce::Array<int> curveParameters;
+    std::array<Snapshot, numSnapshots> snapshots;
+
+    std::atomic<int> currentSnapshot { 0 };
+    std::atomic<juce::uint32> version { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SnapshotBank)
+};
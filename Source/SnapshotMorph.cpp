@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    SnapshotMorph.cpp
+
+  ==============================================================================
+*/
+
+#include "SnapshotMorph.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+SnapshotMorph::SnapshotMorph (const SnapshotBank& snapshotsToUse,
+                              juce::AudioProcessorValueTreeState& apvts,
+                              juce::TimeSliceThread& threadToUse)
+    : snapshots (snapshotsToUse),
+      enabledParameter (apvts.getRawParameterValue ("MorphEnabled")),
+      positionParameter (apvts.getRawParameterValue ("Morph")),
+      fromParameter (apvts.getRawParameterValue ("MorphFrom")),
+      toParameter (apvts.getRawParameterValue ("MorphTo")),
+      compensationParameter (apvts.getRawParameterValue ("Compensation")),
+      thread (threadToUse)
+{
+    thread.addTimeSliceClient (this);
+}
+
+SnapshotMorph::~SnapshotMorph()
+{
+    thread.removeTimeSliceClient (this);
+}
+
+//==============================================================================
+void SnapshotMorph::prepare (double filterSampleRate, double hostSampleRate)
+{
+    RealtimeSafety::checkBlockingCall ("SnapshotMorph::prepare");
+
+    const juce::ScopedLock sl (designLock);
+
+    sampleRate = filterSampleRate;
+    hostRate = hostSampleRate;
+    design();
+}
+
+const SnapshotMorph::Endpoints* SnapshotMorph::getEndpoints() noexcept
+{
+    auto& latest = endpoints.read();
+
+    if (latest.versions[0] == 0 || latest.sampleRate != sampleRate.load()
+         || latest.from != getFrom() || latest.to != getTo())
+        return nullptr;
+
+    return &latest;
+}
+
+ChainSettings SnapshotMorph::getMorphedSettings (int channel)
+{
+    const juce::ScopedLock sl (designLock);
+
+    // Nothing to design for before the first prepare
+    if (hostRate <= 0.0)
+        return ChainSettings::interpolate (getChainSettings (snapshots.getChainParameters (getFrom(), channel)),
+                                           getChainSettings (snapshots.getChainParameters (getTo(), channel)),
+                                           juce::jlimit (0.0f, 1.0f, getPosition()));
+
+    if (needsDesign())
+        design();
+
+    auto& ends = designed.settings[(size_t) channel];
+    return ChainSettings::interpolate (ends[0], ends[1], juce::jlimit (0.0f, 1.0f, getPosition()));
+}
+
+//==============================================================================
+int SnapshotMorph::useTimeSlice()
+{
+    const juce::ScopedLock sl (designLock);
+
+    if (hostRate <= 0.0 || ! isEnabled())
+        return 50;
+
+    if (needsDesign())
+        design();
+
+    return 10;
+}
+
+bool SnapshotMorph::needsDesign() const noexcept
+{
+    return designed.versions[0] == 0
+        || designed.from != getFrom() || designed.to != getTo()
+        || designed.sampleRate != sampleRate.load()
+        || designedSnapshotVersion != snapshots.getVersion()
+        || designedCompensated != isCompensated();
+}
+
+void SnapshotMorph::design()
+{
+    designedSnapshotVersion = snapshots.getVersion();
+    designedCompensated = isCompensated();
+    designed.from = getFrom();
+    designed.to = getTo();
+    designed.sampleRate = sampleRate.load();
+
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        for (int end = 0; end < 2; ++end)
+        {
+            auto settings = getChainSettings (snapshots.getChainParameters (end == 0 ? designed.from : designed.to, channel));
+
+            if (designedCompensated)
+                solver.compensate (settings, hostRate);
+
+            designed.settings[(size_t) channel][(size_t) end] = settings;
+            designed.sets[(size_t) channel][(size_t) end] = CoefficientEngine::designAll (designed.sampleRate, settings);
+        }
+
+        designed.versions[(size_t) channel] = nextVersion++;
+    }
+
+    endpoints.write (designed);
+}
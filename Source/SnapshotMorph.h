@@ -0,0 +1,107 @@
+/*
+  ==============================================================================
+
+    SnapshotMorph.h
+
+    Morphing between two snapshots. Whenever the pair, their contents, the
+    compensation or the rate change, a background thread designs every stage
+    of both snapshots, for both channels, and hands the four coefficient sets
+    to the audio thread, which only has to interpolate between them as the
+    position moves: no redesigns and no allocation, however fast the morph
+    control is automated.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "BandCompensator.h"
+#include "SnapshotBank.h"
+
+//==============================================================================
+class SnapshotMorph  : private juce::TimeSliceClient
+{
+public:
+    /** Both ends of a morph, designed for one rate. */
+    struct Endpoints
+    {
+        /** Indexed by channel, then by end: 0 is the "from" snapshot. */
+        std::array<std::array<CoefficientEngine::CoefficientSet, 2>, 2> sets;
+        std::array<std::array<ChainSettings, 2>, 2> settings;
+
+        int from = 0, to = 0;
+        double sampleRate = 0.0;
+
+        /** Each channel's pair gets a version of its own, counting up with every
+            design, so an engine copied from the other channel's still picks up
+            its own sets. 0 is nothing designed yet. */
+        std::array<juce::uint32, 2> versions {};
+    };
+
+    SnapshotMorph (const SnapshotBank& snapshotsToUse,
+                   juce::AudioProcessorValueTreeState& apvts,
+                   juce::TimeSliceThread& threadToUse);
+    ~SnapshotMorph() override;
+
+    //==============================================================================
+    /** Designs the current pair straight away, so the first block can morph.
+        The sets are designed at the filter rate, and compensation solved at
+        the host's. Call from prepareToPlay.
+    */
+    void prepare (double filterSampleRate, double hostSampleRate);
+
+    /** Moves the design to another filter rate, when the oversampling changes.
+        Safe from the audio thread.
+    */
+    void setSampleRate (double newFilterSampleRate) noexcept    { sampleRate = newFilterSampleRate; }
+
+    bool isEnabled() const noexcept    { return enabledParameter->load() >= 0.5f; }
+    float getPosition() const noexcept    { return positionParameter->load(); }
+
+    /** Audio thread only: the newest endpoints, or nullptr until they match the
+        selected pair and the current rate. Valid until the next call.
+    */
+    const Endpoints* getEndpoints() noexcept;
+
+    /** The settings at the current position, the dB and log frequency way
+        CoefficientEngine ramps, for whatever can't interpolate coefficients:
+        the linear-phase kernel and the display. Not for the audio thread.
+    */
+    ChainSettings getMorphedSettings (int channel = 0);
+
+private:
+    //==============================================================================
+    int useTimeSlice() override;
+
+    int getFrom() const noexcept    { return juce::jlimit (0, SnapshotBank::numSnapshots - 1, juce::roundToInt (fromParameter->load())); }
+    int getTo() const noexcept      { return juce::jlimit (0, SnapshotBank::numSnapshots - 1, juce::roundToInt (toParameter->load())); }
+    bool isCompensated() const noexcept    { return compensationParameter->load() >= 0.5f; }
+
+    /** True if the current request differs from the last design. Called with designLock held. */
+    bool needsDesign() const noexcept;
+
+    /** Designs and publishes the current pair. Called with designLock held. */
+    void design();
+
+    //==============================================================================
+    const SnapshotBank& snapshots;
+    std::atomic<float>* enabledParameter;
+    std::atomic<float>* positionParameter;
+    std::atomic<float>* fromParameter;
+    std::atomic<float>* toParameter;
+    std::atomic<float>* compensationParameter;
+    juce::TimeSliceThread& thread;
+
+    juce::CriticalSection designLock;
+    CompensationSolver solver;
+    Endpoints designed;
+    juce::uint32 designedSnapshotVersion = 0;
+    bool designedCompensated = false;
+    juce::uint32 nextVersion = 1;
+    double hostRate = 0.0;
+
+    TripleBuffer<Endpoints> endpoints;
+    std::atomic<double> sampleRate { 0.0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SnapshotMorph)
+};
@@ -0,0 +1,250 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer (juce::TimeSliceThread& threadToUse)
+    : thread (threadToUse)
+{
+    thread.addTimeSliceClient (this);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    thread.removeTimeSliceClient (this);
+}
+
+int SpectrumAnalyzer::getFftOrder (double sampleRate) noexcept
+{
+    // Keeps the bins around 10 Hz wide, which the 31 Hz band needs
+    if (sampleRate <= 50000.0)   return 12;
+    if (sampleRate <= 100000.0)  return 13;
+
+    return 14;
+}
+
+float SpectrumAnalyzer::getNormalisedX (double frequency) noexcept
+{
+    return (float) (std::log (frequency / minimumFrequency) / std::log (maximumFrequency / minimumFrequency));
+}
+
+float SpectrumAnalyzer::getNormalisedY (float decibels) noexcept
+{
+    return juce::jmap (juce::jlimit (minimumDecibels, maximumDecibels, decibels),
+                       minimumDecibels, maximumDecibels, 1.0f, 0.0f);
+}
+
+//==============================================================================
+void SpectrumAnalyzer::prepare (double newSampleRate)
+{
+    RealtimeSafety::checkBlockingCall ("SpectrumAnalyzer::prepare");
+
+    const juce::ScopedLock sl (analysisLock);
+
+    sampleRate = newSampleRate;
+
+    auto order = getFftOrder (sampleRate);
+    fftSize = 1 << order;
+    fft = std::make_unique<juce::dsp::FFT> (order);
+    fftBuffer.assign ((size_t) (2 * fftSize), 0.0f);
+
+    // At least 60 frames a second, and never less than 50% overlap
+    hopSize = juce::jlimit (1, fftSize / 2, (int) std::ceil (sampleRate / 60.0));
+
+    window.resize ((size_t) fftSize);
+    juce::dsp::WindowingFunction<float>::fillWindowingTables (window.data(), (size_t) fftSize,
+                                                              juce::dsp::WindowingFunction<float>::hann, false);
+
+    // Scales a full-scale sine to 0 dB
+    magnitudeScale = 2.0f / std::accumulate (window.begin(), window.end(), 0.0f);
+
+    auto secondsPerFrame = hopSize / sampleRate;
+    averagingCoefficient = (float) std::exp (-secondsPerFrame / averagingTimeSeconds);
+    peakDecay = (float) std::pow (10.0, -peakDecayDecibelsPerSecond * secondsPerFrame / 10.0);    // a power ratio
+
+    // Room for a quarter of a second, so the background thread can fall well behind
+    auto fifoSize = juce::nextPowerOfTwo ((int) (sampleRate * 0.25));
+    auto numBins = fftSize / 2 + 1;
+
+    for (auto& state : taps)
+    {
+        state.fifo.setTotalSize (fifoSize);
+        state.ring.setSize (fifoChannels, fifoSize);
+        state.ring.clear();
+        state.history.assign ((size_t) fftSize, 0.0f);
+        state.averaged.assign ((size_t) numBins, 0.0f);
+        state.peak.assign ((size_t) numBins, 0.0f);
+        state.samplesSinceFrame = 0;
+    }
+
+    pathPoints.clear();
+
+    auto nyquist = sampleRate * 0.5;
+    auto binsPerHz = fftSize / sampleRate;
+    auto halfStep = 0.5 / (numPathPoints - 1);
+
+    for (int i = 0; i < numPathPoints; ++i)
+    {
+        auto x = (double) i / (numPathPoints - 1);
+        auto frequency = juce::mapToLog10 (x, minimumFrequency, maximumFrequency);
+
+        if (frequency >= nyquist)
+            break;
+
+        auto lowEdge  = juce::mapToLog10 (juce::jmax (0.0, x - halfStep), minimumFrequency, maximumFrequency) * binsPerHz;
+        auto highEdge = juce::mapToLog10 (juce::jmin (1.0, x + halfStep), minimumFrequency, maximumFrequency) * binsPerHz;
+        auto bin = frequency * binsPerHz;
+
+        PathPoint point { (float) x, (int) bin, (int) bin + 1, (float) (bin - std::floor (bin)) };
+
+        if (highEdge - lowEdge >= 1.0)
+        {
+            point.firstBin = (int) std::ceil (lowEdge);
+            point.lastBin = (int) std::floor (highEdge);
+            point.fraction = -1.0f;
+        }
+
+        point.lastBin = juce::jmin (point.lastBin, numBins - 1);
+        point.firstBin = juce::jmin (point.firstBin, point.lastBin);
+        pathPoints.push_back (point);
+    }
+
+    for (auto* paths : { &building, &published })
+        for (auto* path : { &paths->pre, &paths->post, &paths->peakHold })
+        {
+            path->clear();
+            path->preallocateSpace (3 * numPathPoints);
+        }
+}
+
+juce::uint32 SpectrumAnalyzer::getPaths (Paths& destination) const
+{
+    const juce::SpinLock::ScopedLockType sl (publishedLock);
+
+    destination = published;
+    return version.load();
+}
+
+//==============================================================================
+int SpectrumAnalyzer::useTimeSlice()
+{
+    const juce::ScopedLock sl (analysisLock);
+
+    if (sampleRate <= 0.0 || numViewers.load() == 0)
+        return 100;
+
+    auto analysed = false;
+
+    for (auto& state : taps)
+        analysed = drain (state) || analysed;
+
+    if (analysed)
+        publishPaths();
+
+    // Polls at twice the frame rate, so a frame is never late by more than half a frame
+    return 8;
+}
+
+bool SpectrumAnalyzer::drain (TapState& state)
+{
+    auto analysed = false;
+
+    for (;;)
+    {
+        int start1, size1, start2, size2;
+        state.fifo.prepareToRead (hopSize - state.samplesSinceFrame, start1, size1, start2, size2);
+
+        if (size1 + size2 == 0)
+            return analysed;
+
+        appendToHistory (state, start1, size1);
+        appendToHistory (state, start2, size2);
+        state.fifo.finishedRead (size1 + size2);
+
+        state.samplesSinceFrame += size1 + size2;
+
+        if (state.samplesSinceFrame == hopSize)
+        {
+            analyseFrame (state);
+            state.samplesSinceFrame = 0;
+            analysed = true;
+        }
+    }
+}
+
+void SpectrumAnalyzer::appendToHistory (TapState& state, int start, int numSamples) noexcept
+{
+    if (numSamples == 0)
+        return;
+
+    auto& history = state.history;
+    std::copy (history.begin() + numSamples, history.end(), history.begin());
+
+    auto* left = state.ring.getReadPointer (0, start);
+    auto* right = state.ring.getReadPointer (1, start);
+    auto* destination = history.data() + fftSize - numSamples;
+
+    for (int i = 0; i < numSamples; ++i)
+        destination[i] = 0.5f * (left[i] + right[i]);
+}
+
+void SpectrumAnalyzer::analyseFrame (TapState& state)
+{
+    std::transform (state.history.begin(), state.history.end(), window.begin(), fftBuffer.begin(), std::multiplies<float>());
+    std::fill (fftBuffer.begin() + fftSize, fftBuffer.end(), 0.0f);
+
+    fft->performFrequencyOnlyForwardTransform (fftBuffer.data());
+
+    for (size_t bin = 0; bin < state.averaged.size(); ++bin)
+    {
+        auto magnitude = fftBuffer[bin] * magnitudeScale;
+        auto power = magnitude * magnitude;
+        auto& averaged = state.averaged[bin];
+
+        averaged = power + (averaged - power) * averagingCoefficient;
+        state.peak[bin] = juce::jmax (averaged, state.peak[bin] * peakDecay);
+    }
+}
+
+void SpectrumAnalyzer::publishPaths()
+{
+    makePath (taps[preEq].averaged, building.pre);
+    makePath (taps[postEq].averaged, building.post);
+    makePath (taps[postEq].peak, building.peakHold);
+
+    {
+        const juce::SpinLock::ScopedLockType sl (publishedLock);
+        std::swap (building, published);
+    }
+
+    ++version;
+}
+
+void SpectrumAnalyzer::makePath (const std::vector<float>& power, juce::Path& path) const
+{
+    path.clear();
+
+    for (auto& point : pathPoints)
+    {
+        float value;
+
+        if (point.fraction >= 0.0f)
+            value = power[(size_t) point.firstBin] + (power[(size_t) point.lastBin] - power[(size_t) point.firstBin]) * point.fraction;
+        else
+            value = *std::max_element (power.begin() + point.firstBin, power.begin() + point.lastBin + 1);
+
+        auto y = getNormalisedY (10.0f * std::log10 (value + 1.0e-20f));
+
+        if (&point == &pathPoints.front())
+            path.startNewSubPath (point.x, y);
+        else
+            path.lineTo (point.x, y);
+    }
+}
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+
+    Pre/post EQ spectrum analysis. The audio thread copies each block into a
+    wait-free single-producer/single-consumer FIFO per tap and does nothing
+    else; the background thread windows and transforms the signal, averages
+    and peak-holds the spectra, and publishes them as paths in a unit square
+    that an editor only has to scale and stroke.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class SpectrumAnalyzer  : private juce::TimeSliceClient
+{
+public:
+    enum Tap
+    {
+        preEq,
+        postEq,
+        numTaps
+    };
+
+    /** Spectra as ready-to-draw paths: x runs from minimumFrequency to
+        maximumFrequency on a log scale, y from maximumDecibels down to
+        minimumDecibels, both over 0 to 1.
+    */
+    struct Paths
+    {
+        juce::Path pre, post, peakHold;
+    };
+
+    explicit SpectrumAnalyzer (juce::TimeSliceThread& threadToUse);
+    ~SpectrumAnalyzer() override;
+
+    //==============================================================================
+    /** Sizes the FIFOs and the transform for a sample rate. Call from
+        prepareToPlay, while the audio thread is not pushing.
+    */
+    void prepare (double sampleRate);
+
+    /** Copies a block into a tap's FIFO. Only the first two channels are
+        kept; mono is copied into both. Samples that don't fit are dropped,
+        and nothing is copied while no view is registered.
+    */
+    template <typename SampleType>
+    void push (Tap tap, const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        if (numViewers.load (std::memory_order_relaxed) == 0 || block.getNumChannels() == 0)
+            return;
+
+        auto& state = taps[tap];
+        int start1, size1, start2, size2;
+        state.fifo.prepareToWrite ((int) block.getNumSamples(), start1, size1, start2, size2);
+
+        for (int channel = 0; channel < fifoChannels; ++channel)
+        {
+            auto* source = block.getChannelPointer ((size_t) juce::jmin (channel, (int) block.getNumChannels() - 1));
+            auto* destination = state.ring.getWritePointer (channel);
+
+            std::copy (source, source + size1, destination + start1);
+            std::copy (source + size1, source + size1 + size2, destination + start2);
+        }
+
+        state.fifo.finishedWrite (size1 + size2);
+    }
+
+    //==============================================================================
+    /** Views register while they are showing, so the analysis (and the copy on
+        the audio thread) only runs when somebody is looking.
+    */
+    void addViewer() noexcept       { ++numViewers; }
+    void removeViewer() noexcept    { --numViewers; }
+
+    /** Copies the latest paths and returns the version they belong to. */
+    juce::uint32 getPaths (Paths& destination) const;
+
+    /** Bumped every time new paths are published. */
+    juce::uint32 getVersion() const noexcept    { return version.load(); }
+
+    static constexpr double minimumFrequency = 20.0, maximumFrequency = 20000.0;
+    static constexpr float minimumDecibels = -90.0f, maximumDecibels = 6.0f;
+
+    /** Where a frequency or level falls in the unit square of the Paths. */
+    static float getNormalisedX (double frequency) noexcept;
+    static float getNormalisedY (float decibels) noexcept;
+
+private:
+    //==============================================================================
+    struct TapState
+    {
+        juce::AbstractFifo fifo { 1 };
+        juce::AudioBuffer<float> ring;
+        std::vector<float> history;        // the last fftSize samples, mixed to mono
+        std::vector<float> averaged;       // power per bin
+        std::vector<float> peak;           // power per bin
+        int samplesSinceFrame = 0;
+    };
+
+    /** The bins each path point is drawn from: interpolated between two bins
+        where they are wider than the point spacing, the loudest of the range
+        where they are narrower.
+    */
+    struct PathPoint
+    {
+        float x;
+        int firstBin, lastBin;
+        float fraction;
+    };
+
+    int useTimeSlice() override;
+
+    /** Reads whatever the audio thread has written, analysing a frame every
+        hopSize samples. Returns true if any frame was analysed.
+    */
+    bool drain (TapState& state);
+    void appendToHistory (TapState& state, int start, int numSamples) noexcept;
+    void analyseFrame (TapState& state);
+    void publishPaths();
+    void makePath (const std::vector<float>& power, juce::Path& path) const;
+
+    static int getFftOrder (double sampleRate) noexcept;
+
+    //==============================================================================
+    static constexpr int fifoChannels = 2;
+    static constexpr int numPathPoints = 256;
+    static constexpr double averagingTimeSeconds = 0.15;
+    static constexpr double peakDecayDecibelsPerSecond = 12.0;
+
+    juce::TimeSliceThread& thread;
+    juce::CriticalSection analysisLock;
+
+    TapState taps[numTaps];
+    std::atomic<int> numViewers { 0 };
+
+    double sampleRate = 0.0;
+    int fftSize = 0, hopSize = 0;
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::vector<float> window, fftBuffer;
+    std::vector<PathPoint> pathPoints;
+    float magnitudeScale = 1.0f, averagingCoefficient = 0.0f, peakDecay = 0.0f;
+
+    Paths building, published;
+    juce::SpinLock publishedLock;
+    std::atomic<juce::uint32> version { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzer)
+};
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumDisplay.h"
+
+//==============================================================================
+SpectrumDisplay::SpectrumDisplay (GraphicEqAudioProcessor& processorToUse)
+    : audioProcessor (processorToUse),
+      analyzer (processorToUse.getSpectrumAnalyzer())
+{
+    setOpaque (true);
+    analyzer.addViewer();
+    startTimerHz (60);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+    analyzer.removeViewer();
+}
+
+//==============================================================================
+void SpectrumDisplay::paint (juce::Graphics& g)
+{
+    g.drawImageAt (grid, 0, 0);
+
+    auto bounds = getLocalBounds().toFloat();
+    auto transform = juce::AffineTransform::scale (bounds.getWidth(), bounds.getHeight());
+
+    g.setColour (juce::Colours::grey.withAlpha (0.6f));
+    g.strokePath (paths.pre, juce::PathStrokeType (1.0f), transform);
+
+    g.setColour (juce::Colours::orange.withAlpha (0.5f));
+    g.strokePath (paths.peakHold, juce::PathStrokeType (1.0f), transform);
+
+    g.setColour (juce::Colours::orange);
+    g.strokePath (paths.post, juce::PathStrokeType (1.5f), transform);
+
+    g.setColour (juce::Colours::white);
+    g.strokePath (responseCurve.getPath(), juce::PathStrokeType (2.0f), transform);
+}
+
+void SpectrumDisplay::resized()
+{
+    renderGrid();
+}
+
+void SpectrumDisplay::timerCallback()
+{
+    auto needsRepaint = responseCurve.update (audioProcessor.getTargetSettings(),
+                                              audioProcessor.getFilterSampleRate());
+
+    if (analyzer.getVersion() != displayedVersion)
+    {
+        displayedVersion = analyzer.getPaths (paths);
+        needsRepaint = true;
+    }
+
+    if (needsRepaint)
+        repaint();
+}
+
+void SpectrumDisplay::renderGrid()
+{
+    auto width = juce::jmax (1, getWidth());
+    auto height = juce::jmax (1, getHeight());
+
+    grid = juce::Image (juce::Image::RGB, width, height, true);
+    juce::Graphics g (grid);
+
+    g.fillAll (juce::Colours::black);
+    g.setFont (10.0f);
+
+    for (auto frequency : { 50.0, 100.0, 200.0, 500.0, 1000.0, 2000.0, 5000.0, 10000.0 })
+    {
+        auto x = SpectrumAnalyzer::getNormalisedX (frequency) * (float) width;
+        auto label = frequency >= 1000.0 ? juce::String (frequency / 1000.0) + "k" : juce::String (frequency);
+
+        g.setColour (juce::Colours::darkgrey);
+        g.drawVerticalLine (juce::roundToInt (x), 0.0f, (float) height);
+        g.setColour (juce::Colours::grey);
+        g.drawText (label, juce::roundToInt (x) + 2, height - 14, 40, 12, juce::Justification::left);
+    }
+
+    for (auto decibels = 0.0f; decibels > SpectrumAnalyzer::minimumDecibels; decibels -= 12.0f)
+    {
+        auto y = SpectrumAnalyzer::getNormalisedY (decibels) * (float) height;
+
+        g.setColour (juce::Colours::darkgrey);
+        g.drawHorizontalLine (juce::roundToInt (y), 0.0f, (float) width);
+        g.setColour (juce::Colours::grey);
+        g.drawText (juce::String (juce::roundToInt (decibels)) + " dB", 2, juce::roundToInt (y) + 1, 50, 12,
+                    juce::Justification::left);
+    }
+
+    // The response curve has its own scale, centred on 0 dB
+    for (auto decibels : { ResponseCurve::rangeDecibels / 2, -ResponseCurve::rangeDecibels / 2 })
+    {
+        auto y = juce::jmap (decibels, -ResponseCurve::rangeDecibels, ResponseCurve::rangeDecibels, 1.0f, 0.0f) * (float) height;
+
+        g.setColour (juce::Colours::lightgrey);
+        g.drawText (juce::String (juce::roundToInt (decibels)) + " dB", width - 52, juce::roundToInt (y) + 1, 50, 12,
+                    juce::Justification::right);
+    }
+
+    g.setColour (juce::Colours::grey);
+    g.drawHorizontalLine (height / 2, 0.0f, (float) width);
+}
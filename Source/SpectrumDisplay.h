@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    SpectrumDisplay.h
+
+    Draws the pre/post EQ spectrum and the EQ's response curve over a cached
+    grid. Repaints at up to 60 Hz, and only when the analyzer has published
+    something new or the settings have changed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "PluginProcessor.h"
+#include "ResponseCurve.h"
+
+//==============================================================================
+class SpectrumDisplay  : public juce::Component,
+                         private juce::Timer
+{
+public:
+    explicit SpectrumDisplay (GraphicEqAudioProcessor& processorToUse);
+    ~SpectrumDisplay() override;
+
+    //==============================================================================
+    void paint (juce::Graphics&) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+
+    /** Renders the frequency and level grid, which only changes with the size. */
+    void renderGrid();
+
+    GraphicEqAudioProcessor& audioProcessor;
+    SpectrumAnalyzer& analyzer;
+    SpectrumAnalyzer::Paths paths;
+    juce::uint32 displayedVersion = 0;
+    ResponseCurve responseCurve;
+    juce::Image grid;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumDisplay)
+};
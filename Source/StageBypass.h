@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    StageBypass.h
+
+    Tracks which cascade stages are acoustically neutral so the processing
+    engines can skip them. A stage that becomes neutral is faded out before it
+    is skipped, and a stage that leaves neutral is faded back in from a clean
+    state, so switching never clicks.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+class StageBypass
+{
+public:
+    using StageMask = juce::uint64;
+
+    static constexpr int maxStages = 64;
+
+    /** Linear wet/dry ramp for a fading stage: the gain applied to sample i of
+        the block is jlimit (0, 1, start + (i + 1) * step).
+    */
+    struct Fade
+    {
+        float start, step;
+
+        float getGain (int sampleIndex) const noexcept
+        {
+            return juce::jlimit (0.0f, 1.0f, start + (float) (sampleIndex + 1) * step);
+        }
+    };
+
+    //==============================================================================
+    void prepare (double sampleRate, double fadeLengthSeconds = 0.01) noexcept
+    {
+        fadeStep = (float) (1.0 / juce::jmax (1.0, sampleRate * fadeLengthSeconds));
+    }
+
+    /** Jumps straight to the given neutral set, without fading. */
+    void reset (StageMask neutralStages) noexcept
+    {
+        for (int stage = 0; stage < maxStages; ++stage)
+            gains[(size_t) stage] = isSet (neutralStages, stage) ? 0.0f : 1.0f;
+
+        neutral = neutralStages;
+    }
+
+    /** Fades the given stages in again from silence, the ones that aren't
+        neutral, for when something other than the cascade has been running
+        them. Their filter state should be cleared to match.
+    */
+    void restartStages (StageMask stages) noexcept
+    {
+        for (int stage = 0; stage < maxStages; ++stage)
+            if (isSet (stages, stage))
+                gains[(size_t) stage] = 0.0f;
+    }
+
+    /** Stages whose bit changed start fading towards their new state. */
+    void setNeutralStages (StageMask neutralStages) noexcept    { neutral = neutralStages; }
+
+    /** A copy that skips the given stages outright, for when something other
+        than the cascade is running them. */
+    StageBypass withoutStages (StageMask stages) const noexcept
+    {
+        auto copy = *this;
+
+        for (int stage = 0; stage < maxStages; ++stage)
+            if (isSet (stages, stage))
+                copy.gains[(size_t) stage] = 0.0f;
+
+        copy.neutral |= stages;
+        return copy;
+    }
+
+    //==============================================================================
+    /** True if the stage has to run this block, either fully or fading. */
+    bool isProcessed (int stage) const noexcept    { return gains[(size_t) stage] > 0.0f || ! isSet (neutral, stage); }
+
+    bool isFading (int stage) const noexcept
+    {
+        auto target = isSet (neutral, stage) ? 0.0f : 1.0f;
+        return gains[(size_t) stage] != target;
+    }
+
+    Fade getFade (int stage) const noexcept
+    {
+        return { gains[(size_t) stage], isSet (neutral, stage) ? -fadeStep : fadeStep };
+    }
+
+    /** Moves every fade on by numSamples. Returns the stages that have just
+        finished fading out, whose filter state the caller should clear so a
+        later fade-in starts from silence.
+    */
+    StageMask advance (int numSamples) noexcept
+    {
+        StageMask finished = 0;
+
+        for (int stage = 0; stage < maxStages; ++stage)
+        {
+            if (! isFading (stage))
+                continue;
+
+            auto newGain = getFade (stage).getGain (numSamples - 1);
+            gains[(size_t) stage] = newGain;
+
+            if (newGain == 0.0f)
+                finished |= (StageMask (1) << stage);
+        }
+
+        return finished;
+    }
+
+private:
+    static bool isSet (StageMask mask, int stage) noexcept    { return (mask & (StageMask (1) << stage)) != 0; }
+
+    std::array<float, maxStages> gains {};
+    StageMask neutral = 0;
+    float fadeStep = 1.0f / 441.0f;
+};
@@ -0,0 +1,50 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+
+    Wait-free hand-over of a value from one writer thread to one reader
+    thread. The writer fills a private slot and swaps it with the shared
+    middle slot in one atomic exchange; the reader swaps the middle slot for
+    its own whenever something new has arrived. Neither side ever waits, and
+    the reader always sees a complete value.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+template <typename Type>
+class TripleBuffer
+{
+public:
+    static_assert (std::is_trivially_copyable<Type>::value, "Slots are copied on the audio thread");
+
+    /** Writer only: publishes a value, replacing any the reader hasn't taken yet. */
+    void write (const Type& value) noexcept
+    {
+        slots[(size_t) back] = value;
+        back = middle.exchange (back | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    /** Reader only: the most recently published value, or a default-constructed
+        one if nothing has been written yet.
+    */
+    const Type& read() noexcept
+    {
+        if ((middle.load (std::memory_order_relaxed) & newDataFlag) != 0)
+            front = middle.exchange (front, std::memory_order_acq_rel) & indexMask;
+
+        return slots[(size_t) front];
+    }
+
+private:
+    static constexpr int indexMask = 3, newDataFlag = 4;
+
+    std::array<Type, 3> slots {};
+    int back = 0, front = 1;
+    std::atomic<int> middle { 2 };
+};
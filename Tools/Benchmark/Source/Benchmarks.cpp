@@ -0,0 +1,547 @@
+/*
+  ==============================================================================
+
+    Benchmarks.cpp
+
+  ==============================================================================
+*/
+
+#include "Benchmarks.h"
+#include "RealtimeSafety.h"
+
+//==============================================================================
+namespace BenchmarkHelpers
+{
+    double ticksToNanoseconds (juce::int64 ticks) noexcept
+    {
+        return (double) ticks * 1.0e9 / (double) juce::Time::getHighResolutionTicksPerSecond();
+    }
+
+    void setParameter (juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value)
+    {
+        if (auto* parameter = apvts.getParameter (parameterID))
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    void resetParameters (juce::AudioProcessorValueTreeState& apvts, BandMode bandMode)
+    {
+        setParameter (apvts, "LowCut", minimumCutFrequency);
+        setParameter (apvts, "HiCut", maximumCutFrequency);
+        setParameter (apvts, "BandMode", (float) bandMode);
+        setParameter (apvts, "LowCutSlope", 0.0f);
+        setParameter (apvts, "HiCutSlope", 0.0f);
+        setParameter (apvts, "LowCutType", 0.0f);
+        setParameter (apvts, "HiCutType", 0.0f);
+        setParameter (apvts, "ChannelMode", 0.0f);
+        setParameter (apvts, "MorphEnabled", 0.0f);
+        setParameter (apvts, "Morph", 0.0f);
+        setParameter (apvts, "MorphFrom", 0.0f);
+        setParameter (apvts, "MorphTo", 1.0f);
+
+        for (auto mode : { BandMode::octave, BandMode::thirdOctave })
+            for (auto& band : getBandTable (mode))
+                setParameter (apvts, band.parameterID, 0.0f);
+    }
+}
+
+using namespace BenchmarkHelpers;
+
+namespace
+{
+    /** Stores the flat defaults as snapshot A and random bands and cuts as B,
+        then morphs from the one to the other. */
+    void setUpMorph (GraphicEqAudioProcessor& processor, BandMode bandMode)
+    {
+        auto& snapshots = processor.getSnapshotBank();
+        snapshots.store (0);
+
+        juce::Random random (1);
+        setParameter (processor.apvts, "LowCut", 20.0f + 200.0f * random.nextFloat());
+        setParameter (processor.apvts, "HiCut", 2000.0f + 18000.0f * random.nextFloat());
+
+        for (auto& band : getBandTable (bandMode))
+            setParameter (processor.apvts, band.parameterID, 24.0f * random.nextFloat() - 12.0f);
+
+        snapshots.store (1);
+        snapshots.recall (0);
+        setParameter (processor.apvts, "MorphEnabled", 1.0f);
+    }
+
+    /** Moves the bands of the active table, the other table's are ignored anyway. */
+    void applyAutomation (juce::AudioProcessorValueTreeState& apvts, Automation automation,
+                          BandMode bandMode, int blockIndex)
+    {
+        auto bands = getBandTable (bandMode);
+
+        switch (automation)
+        {
+            case Automation::sweep:
+            {
+                auto phase = (float) (blockIndex % 256) / 256.0f;
+                setParameter (apvts, bands.bands[blockIndex / 256 % bands.numBands].parameterID,
+                              12.0f * std::sin (juce::MathConstants<float>::twoPi * phase));
+                break;
+            }
+
+            case Automation::all:
+            {
+                juce::Random random (blockIndex);
+                setParameter (apvts, "LowCut", 20.0f + 200.0f * random.nextFloat());
+                setParameter (apvts, "HiCut", 2000.0f + 18000.0f * random.nextFloat());
+
+                for (auto& band : bands)
+                    setParameter (apvts, band.parameterID, 48.0f * random.nextFloat() - 24.0f);
+
+                break;
+            }
+
+            case Automation::toggle:
+                if (blockIndex % 64 == 0)
+                    setParameter (apvts, bands.bands[0].parameterID, (blockIndex / 64) % 2 == 0 ? 6.0f : 0.0f);
+
+                break;
+
+            case Automation::morph:
+            {
+                auto phase = (float) (blockIndex % 256) / 256.0f;
+                setParameter (apvts, "Morph", 0.5f - 0.5f * std::cos (juce::MathConstants<float>::twoPi * phase));
+                break;
+            }
+
+            case Automation::none:
+            default:
+                break;
+        }
+    }
+}
+
+//==============================================================================
+BenchmarkSuite::BenchmarkSuite (BenchmarkConfig configToUse)
+    : config (std::move (configToUse))
+{
+}
+
+juce::String BenchmarkSuite::getAutomationName (Automation automation)
+{
+    switch (automation)
+    {
+        case Automation::sweep:   return "sweep";
+        case Automation::all:     return "all";
+        case Automation::toggle:  return "toggle";
+        case Automation::morph:   return "morph";
+        case Automation::none:
+        default:                  return "none";
+    }
+}
+
+juce::String BenchmarkSuite::getBandModeName (BandMode mode)
+{
+    return juce::String (getBandTable (mode).numBands);
+}
+
+juce::StringArray BenchmarkSuite::getColumnNames()
+{
+    return { "benchmark", "engine", "bands", "automation", "sampleRate", "blockSize", "channels",
+             "calls", "nsPerSample", "nsPerCall", "allocationsPerCall", "realtimeViolations" };
+}
+
+void BenchmarkSuite::run (std::ostream& out)
+{
+    // Allocation counts come from the realtime-safety hooks
+    static_assert (RealtimeSafety::isEnabled, "Build the benchmark with GRAPHICEQ_RT_CHECKS=1");
+
+    out << getColumnNames().joinIntoString (",") << std::endl;
+
+    runCoefficientDesign (out);
+    runChainSettings (out);
+    runStateInformation (out);
+    runProcessBlock (out);
+    runBatch (out);
+}
+
+void BenchmarkSuite::writeRow (std::ostream& out, const Result& result)
+{
+    auto calls = (double) juce::jmax ((juce::int64) 1, result.calls);
+    auto nsPerSample = result.samples > 0 ? result.nanoseconds / (double) result.samples : 0.0;
+
+    juce::StringArray row { result.benchmark, result.engine, result.bands, result.automation,
+                            juce::String (result.sampleRate), juce::String (result.blockSize),
+                            juce::String (result.numChannels), juce::String (result.calls),
+                            juce::String (nsPerSample, 3), juce::String (result.nanoseconds / calls, 3),
+                            juce::String ((double) result.allocations / calls, 3), juce::String (result.violations) };
+
+    out << row.joinIntoString (",") << std::endl;
+}
+
+//==============================================================================
+void BenchmarkSuite::runProcessBlock (std::ostream& out)
+{
+    using Engine = GraphicEqAudioProcessor::ProcessingEngine;
+
+    struct EngineRun
+    {
+        const char* name;
+        Engine engine;
+        bool parallel;
+    };
+
+    GraphicEqAudioProcessor processor;
+
+    // The parallel bands only run on mono, with the cuts in the SIMD cascade
+    for (auto run : { EngineRun { "scalar", Engine::scalar, false },
+                      EngineRun { "simd", Engine::simd, false },
+                      EngineRun { "parallel", Engine::simd, true } })
+    {
+        setParameter (processor.apvts, "Engine", (float) run.engine);
+        setParameter (processor.apvts, "Parallel", run.parallel ? 1.0f : 0.0f);
+
+        for (auto numChannels : config.channelCounts)
+        {
+            if (run.parallel && numChannels != 1)
+                continue;
+
+            juce::AudioProcessor::BusesLayout layout;
+            layout.inputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+            layout.outputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+
+            if (! processor.setBusesLayout (layout))
+                continue;
+
+            for (auto sampleRate : config.sampleRates)
+            {
+                for (auto blockSize : config.blockSizes)
+                {
+                    for (auto bandMode : config.bandModes)
+                    {
+                        for (auto automation : config.automations)
+                        {
+                            auto result = timeProcessBlock (processor, sampleRate, blockSize, numChannels, bandMode, automation);
+                            result.engine = run.name;
+                            writeRow (out, result);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+BenchmarkSuite::Result BenchmarkSuite::timeProcessBlock (GraphicEqAudioProcessor& processor, double sampleRate, int blockSize,
+                                                         int numChannels, BandMode bandMode, Automation automation)
+{
+    resetParameters (processor.apvts, bandMode);
+
+    if (automation == Automation::morph)
+        setUpMorph (processor, bandMode);
+
+    processor.setRateAndBufferSizeDetails (sampleRate, blockSize);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    // Fresh noise every block, so the filters never settle into denormals or silence
+    juce::AudioBuffer<float> source (numChannels, blockSize * 16), buffer (numChannels, blockSize);
+    juce::Random random (1);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < source.getNumSamples(); ++i)
+            source.setSample (channel, i, random.nextFloat() * 0.5f - 0.25f);
+
+    juce::MidiBuffer midi;
+    auto numBlocks = juce::jmax (64, (int) (config.secondsPerRun * sampleRate) / blockSize);
+    constexpr int warmUpBlocks = 16;
+
+    Result result;
+    result.benchmark = "processBlock";
+    result.bands = getBandModeName (bandMode);
+    result.automation = getAutomationName (automation);
+    result.sampleRate = sampleRate;
+    result.blockSize = blockSize;
+    result.numChannels = numChannels;
+
+    for (int block = -warmUpBlocks; block < numBlocks; ++block)
+    {
+        auto offset = ((block + warmUpBlocks) % 16) * blockSize;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            buffer.copyFrom (channel, 0, source, channel, offset, blockSize);
+
+        applyAutomation (processor.apvts, automation, bandMode, block + warmUpBlocks);
+
+        auto allocationsBefore = RealtimeSafety::getThreadAllocationCount();
+        auto violationsBefore = RealtimeSafety::getCounters().getTotal();
+        auto start = juce::Time::getHighResolutionTicks();
+
+        processor.processBlock (buffer, midi);
+
+        auto elapsed = juce::Time::getHighResolutionTicks() - start;
+        auto allocations = RealtimeSafety::getThreadAllocationCount() - allocationsBefore;
+        auto violations = RealtimeSafety::getCounters().getTotal() - violationsBefore;
+
+        if (block < 0)
+            continue;
+
+        result.nanoseconds += ticksToNanoseconds (elapsed);
+        result.allocations += allocations;
+        result.violations += violations;
+        result.samples += blockSize;
+        ++result.calls;
+    }
+
+    processor.releaseResources();
+    return result;
+}
+
+//==============================================================================
+void BenchmarkSuite::runBatch (std::ostream& out)
+{
+    juce::AudioProcessor::BusesLayout mono;
+    mono.inputBuses.add (juce::AudioChannelSet::mono());
+    mono.outputBuses.add (juce::AudioChannelSet::mono());
+
+    for (auto numTracks : config.trackCounts)
+    {
+        // One mono plugin instance per track, each with settings of its own, the
+        // way a host runs them; the batch takes the same settings from them
+        juce::OwnedArray<GraphicEqAudioProcessor> instances;
+        juce::Random random (4);
+
+        for (int track = 0; track < numTracks; ++track)
+        {
+            auto* instance = instances.add (new GraphicEqAudioProcessor());
+            instance->setBusesLayout (mono);
+            resetParameters (instance->apvts, BandMode::thirdOctave);
+            setParameter (instance->apvts, "LowCut", 20.0f + 200.0f * random.nextFloat());
+            setParameter (instance->apvts, "HiCut", 2000.0f + 18000.0f * random.nextFloat());
+
+            for (auto& band : getBandTable (BandMode::thirdOctave))
+                setParameter (instance->apvts, band.parameterID, 24.0f * random.nextFloat() - 12.0f);
+        }
+
+        for (auto sampleRate : config.sampleRates)
+        {
+            for (auto blockSize : config.blockSizes)
+            {
+                juce::AudioBuffer<float> buffer (numTracks, blockSize);
+                auto numBlocks = juce::jmax (64, (int) (config.secondsPerRun * sampleRate) / blockSize);
+                constexpr int warmUpBlocks = 16;
+
+                // Times numBlocks calls of processTracks over fresh noise
+                auto time = [&] (const juce::String& engine, auto&& processTracks)
+                {
+                    Result result;
+                    result.benchmark = "batch";
+                    result.engine = engine;
+                    result.bands = getBandModeName (BandMode::thirdOctave);
+                    result.sampleRate = sampleRate;
+                    result.blockSize = blockSize;
+                    result.numChannels = numTracks;
+
+                    juce::Random noise (1);
+
+                    for (int block = -warmUpBlocks; block < numBlocks; ++block)
+                    {
+                        for (int track = 0; track < numTracks; ++track)
+                            for (int i = 0; i < blockSize; ++i)
+                                buffer.setSample (track, i, noise.nextFloat() * 0.5f - 0.25f);
+
+                        auto allocationsBefore = RealtimeSafety::getThreadAllocationCount();
+                        auto start = juce::Time::getHighResolutionTicks();
+
+                        processTracks();
+
+                        auto elapsed = juce::Time::getHighResolutionTicks() - start;
+                        auto allocations = RealtimeSafety::getThreadAllocationCount() - allocationsBefore;
+
+                        if (block < 0)
+                            continue;
+
+                        // Per sample of every track
+                        result.nanoseconds += ticksToNanoseconds (elapsed);
+                        result.allocations += allocations;
+                        result.samples += (juce::int64) blockSize * numTracks;
+                        ++result.calls;
+                    }
+
+                    writeRow (out, result);
+                };
+
+                for (auto* instance : instances)
+                {
+                    instance->setRateAndBufferSizeDetails (sampleRate, blockSize);
+                    instance->prepareToPlay (sampleRate, blockSize);
+                }
+
+                juce::MidiBuffer midi;
+
+                time ("instances", [&]
+                {
+                    for (int track = 0; track < numTracks; ++track)
+                    {
+                        juce::AudioBuffer<float> trackBuffer (buffer.getArrayOfWritePointers() + track, 1, blockSize);
+                        instances[track]->processBlock (trackBuffer, midi);
+                    }
+                });
+
+                for (auto* instance : instances)
+                    instance->releaseResources();
+
+                for (auto numThreads : config.threadCounts)
+                {
+                    BatchEq<float> batch;
+                    batch.prepare (sampleRate, numTracks, 1, blockSize, numThreads);
+
+                    for (int track = 0; track < numTracks; ++track)
+                        batch.setSettings (track, getChainSettings (instances[track]->getChainParameters()));
+
+                    time ("batch/" + juce::String (numThreads), [&] { batch.process (buffer.getArrayOfWritePointers(), blockSize); });
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+void BenchmarkSuite::runCoefficientDesign (std::ostream& out)
+{
+    for (auto sampleRate : config.sampleRates)
+    {
+        // Designing single stages from raw settings
+        {
+            Result result;
+            result.benchmark = "designStage";
+            result.bands = getBandModeName (BandMode::thirdOctave);
+            result.sampleRate = sampleRate;
+
+            // The steepest cuts, so every cut section is designed
+            ChainSettings layout;
+            layout.bandMode = BandMode::thirdOctave;
+            layout.lowCutSections = layout.hiCutSections = maxCutSections;
+            layout.lowCutType = layout.hiCutType = CutType::butterworth;
+
+            juce::Random random (2);
+            auto checksum = 0.0;
+            auto allocationsBefore = RealtimeSafety::getThreadAllocationCount();
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < config.iterations; ++i)
+            {
+                auto stage = i % ChainPositions::numChainStages;
+                auto value = isPeakStage (stage) ? random.nextFloat() * 48.0 - 24.0
+                                                 : 20.0 + random.nextFloat() * 19980.0;
+                checksum += CoefficientEngine::designStage (sampleRate, layout, stage, value).b0;
+            }
+
+            result.nanoseconds = ticksToNanoseconds (juce::Time::getHighResolutionTicks() - start);
+            result.allocations = RealtimeSafety::getThreadAllocationCount() - allocationsBefore;
+            result.calls = config.iterations;
+            writeRow (out, result);
+
+            juce::ignoreUnused (checksum);
+        }
+
+        // A full CoefficientEngine update with every stage moving
+        {
+            CoefficientEngine engine;
+            engine.prepare (sampleRate);
+
+            Result result;
+            result.benchmark = "coefficientUpdate";
+            result.bands = getBandModeName (BandMode::thirdOctave);
+            result.sampleRate = sampleRate;
+
+            juce::Random random (3);
+            auto allocationsBefore = RealtimeSafety::getThreadAllocationCount();
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < config.iterations; ++i)
+            {
+                ChainSettings settings;
+                settings.lowCutFreq = 20.0f + 200.0f * random.nextFloat();
+                settings.hiCutFreq = 2000.0f + 18000.0f * random.nextFloat();
+                settings.bandMode = BandMode::thirdOctave;
+                settings.lowCutSections = settings.hiCutSections = maxCutSections;
+                settings.lowCutType = settings.hiCutType = CutType::butterworth;
+
+                for (auto& gain : settings.peakGainInDecibels)
+                    gain = 48.0f * random.nextFloat() - 24.0f;
+
+                engine.setTargets (settings);
+                engine.update();
+            }
+
+            result.nanoseconds = ticksToNanoseconds (juce::Time::getHighResolutionTicks() - start);
+            result.allocations = RealtimeSafety::getThreadAllocationCount() - allocationsBefore;
+            result.calls = config.iterations;
+            writeRow (out, result);
+        }
+    }
+}
+
+void BenchmarkSuite::runChainSettings (std::ostream& out)
+{
+    GraphicEqAudioProcessor processor;
+    ChainParameters parameters (processor.apvts);
+
+    Result result;
+    result.benchmark = "getChainSettings";
+
+    auto checksum = 0.0f;
+    auto allocationsBefore = RealtimeSafety::getThreadAllocationCount();
+    auto start = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < config.iterations; ++i)
+        checksum += getChainSettings (parameters).lowCutFreq;
+
+    result.nanoseconds = ticksToNanoseconds (juce::Time::getHighResolutionTicks() - start);
+    result.allocations = RealtimeSafety::getThreadAllocationCount() - allocationsBefore;
+    result.calls = config.iterations;
+    writeRow (out, result);
+
+    juce::ignoreUnused (checksum);
+}
+
+void BenchmarkSuite::runStateInformation (std::ostream& out)
+{
+    GraphicEqAudioProcessor processor;
+    juce::MemoryBlock state;
+    processor.getStateInformation (state);
+
+    // The ValueTree older sessions hold, restored through the fallback path
+    juce::MemoryBlock legacyState;
+    {
+        juce::MemoryOutputStream stream (legacyState, false);
+        processor.apvts.copyState().writeToStream (stream);
+    }
+
+    // State I/O is far slower than the rest, so fewer iterations keep the run short
+    auto iterations = juce::jmax (1, config.iterations / 10);
+
+    for (auto* name : { "getStateInformation", "setStateInformation", "setStateInformationLegacy" })
+    {
+        Result result;
+        result.benchmark = name;
+
+        auto isSave = result.benchmark == "getStateInformation";
+        auto& source = result.benchmark == "setStateInformationLegacy" ? legacyState : state;
+
+        auto allocationsBefore = RealtimeSafety::getThreadAllocationCount();
+        auto start = juce::Time::getHighResolutionTicks();
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            if (isSave)
+            {
+                juce::MemoryBlock destination;
+                processor.getStateInformation (destination);
+            }
+            else
+            {
+                processor.setStateInformation (source.getData(), (int) source.getSize());
+            }
+        }
+
+        result.nanoseconds = ticksToNanoseconds (juce::Time::getHighResolutionTicks() - start);
+        result.allocations = RealtimeSafety::getThreadAllocationCount() - allocationsBefore;
+        result.calls = iterations;
+        writeRow (out, result);
+    }
+}
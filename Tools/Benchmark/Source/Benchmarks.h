@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    Benchmarks.h
+
+    Timing runs for the processor and the pieces behind it. Every result is
+    one CSV row on the output stream, so runs from different builds can be
+    diffed or loaded straight into a spreadsheet.
+
+    Built with GRAPHICEQ_RT_CHECKS, so processBlock rows also report any
+    realtime-safety violations.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BatchEq.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+/** How parameters move while processBlock is being timed. */
+enum class Automation
+{
+    none,       // nothing changes
+    sweep,      // one peak band ramps every block
+    all,        // every band and both cuts jump every block
+    toggle,     // one band flips in and out of neutral, so its stage fades
+    morph       // the morph control sweeps between two snapshots that differ in every band
+};
+
+struct BenchmarkConfig
+{
+    juce::Array<int> blockSizes { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    juce::Array<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+    juce::Array<int> channelCounts { 1, 2, 8 };
+    juce::Array<Automation> automations { Automation::none, Automation::sweep, Automation::all, Automation::toggle, Automation::morph };
+    juce::Array<BandMode> bandModes { BandMode::octave, BandMode::thirdOctave };
+
+    /** Track counts for the batch benchmark, and how many threads BatchEq runs them on. */
+    juce::Array<int> trackCounts { 128 };
+    juce::Array<int> threadCounts { 1, 2, 4 };
+
+    /** Audio processed per processBlock configuration. */
+    double secondsPerRun = 1.0;
+
+    /** Iterations for the design and state benchmarks. */
+    int iterations = 20000;
+};
+
+//==============================================================================
+/** Shared by the benchmarks and the conformance checks. */
+namespace BenchmarkHelpers
+{
+    double ticksToNanoseconds (juce::int64 ticks) noexcept;
+    void setParameter (juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float value);
+
+    /** Restores the curve, channel and morph parameters to their defaults, so runs
+        don't inherit settings. The engine and precision options are left alone. */
+    void resetParameters (juce::AudioProcessorValueTreeState& apvts, BandMode bandMode);
+}
+
+//==============================================================================
+class BenchmarkSuite
+{
+public:
+    explicit BenchmarkSuite (BenchmarkConfig configToUse);
+
+    /** Runs everything, writing the CSV header and then a row per result. */
+    void run (std::ostream& out);
+
+    static juce::String getAutomationName (Automation automation);
+    static juce::String getBandModeName (BandMode mode);
+    static juce::StringArray getColumnNames();
+
+private:
+    //==============================================================================
+    struct Result
+    {
+        juce::String benchmark, engine = "-", bands = "-", automation = "-";
+        double sampleRate = 0.0;
+        int blockSize = 0, numChannels = 0;
+        juce::int64 calls = 0, samples = 0, allocations = 0, violations = 0;
+        double nanoseconds = 0.0;
+    };
+
+    void runProcessBlock (std::ostream& out);
+    void runBatch (std::ostream& out);
+    void runCoefficientDesign (std::ostream& out);
+    void runChainSettings (std::ostream& out);
+    void runStateInformation (std::ostream& out);
+
+    Result timeProcessBlock (GraphicEqAudioProcessor& processor, double sampleRate, int blockSize,
+                             int numChannels, BandMode bandMode, Automation automation);
+
+    static void writeRow (std::ostream& out, const Result& result);
+
+    BenchmarkConfig config;
+};
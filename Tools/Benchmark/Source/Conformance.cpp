@@ -0,0 +1,758 @@
+/*
+  ==============================================================================
+
+    Conformance.cpp
+
+  ==============================================================================
+*/
+
+#include "Conformance.h"
+#include "Benchmarks.h"
+#include "PluginState.h"
+
+namespace
+{
+    /** How much worse than the float reference a float path may be: in dB for
+        the sample error, as a factor for magnitude and phase deviations. */
+    constexpr double floatMarginDecibels = 6.0;
+    constexpr double floatMarginFactor = 2.0;
+
+    /** Golden renders are stored as 32-bit float, which limits how closely
+        they can match. */
+    constexpr double goldenErrorDecibels = -120.0;
+
+    /** Longest tail rendered; longer ones are truncated. */
+    constexpr double maximumTailSeconds = 4.0;
+
+    /** Long enough for the parallel form to prime and fade in a new expansion,
+        however many of its poles moved. */
+    constexpr double switchSeconds = 1.0;
+}
+
+using Engine = GraphicEqAudioProcessor::ProcessingEngine;
+
+// These limits, and the band change's, came from a standalone simulation of
+// the arithmetic rather than from processBlock itself; set them from the worst
+// values a full run lists on stderr.
+const ConformanceSuite::Path ConformanceSuite::paths[numPaths] =
+{
+    // name                engine          precision                  parallel  smoothing  speed  forSpeed  error    magnitude  phase
+    { "scalar",            Engine::scalar, Precision::singleFloat,    false,    0,         0,     false,    { -120.0, 0.001,     0.01 } },
+    { "scalar/double",     Engine::scalar, Precision::doubleFloat,    false,    0,         1,     false,    { -120.0, 0.001,     0.01 } },
+    { "simd",              Engine::simd,   Precision::singleFloat,    false,    0,         0,     true,     { -120.0, 0.001,     0.01 } },
+    { "simd/double",       Engine::simd,   Precision::doubleFloat,    false,    0,         1,     true,     { -140.0, 0.001,     0.01 } },
+    { "highPrecision",     Engine::scalar, Precision::highPrecision,  false,    0,         0,     false,    { -130.0, 0.001,     0.01 } },
+    { "parallel",          Engine::simd,   Precision::singleFloat,    true,     0,         2,     true,     { -120.0, 0.001,     0.01 } },
+    { "parallel/double",   Engine::simd,   Precision::doubleFloat,    true,     0,         3,     true,     { -80.0,  0.002,     0.02 } },
+    { "smoothing",         Engine::scalar, Precision::singleFloat,    false,    1,         0,     false,    { -120.0, 0.001,     0.01 } },
+    { "smoothing/double",  Engine::scalar, Precision::doubleFloat,    false,    1,         1,     false,    { -100.0, 0.001,     0.01 } }
+};
+
+//==============================================================================
+ConformanceSuite::ConformanceSuite (ConformanceConfig configToUse)
+    : config (std::move (configToUse))
+{
+    formats.registerBasicFormats();
+}
+
+juce::StringArray ConformanceSuite::getColumnNames()
+{
+    return { "check", "path", "bands", "signal", "sampleRate", "blockSize", "channels",
+             "maxErrorDb", "magnitudeDb", "phaseDegrees", "nsPerSample", "speedup", "result" };
+}
+
+int ConformanceSuite::run (std::ostream& out)
+{
+    out << getColumnNames().joinIntoString (",") << std::endl;
+
+    numChecks = 0;
+    numFailures = 0;
+    worst.clear();
+
+    for (auto bandMode : config.bandModes)
+    {
+        // The curve as the processor reads it from its own parameters
+        ChainSettings settings;
+
+        {
+            GraphicEqAudioProcessor probe;
+            applyTestCurve (probe.apvts, bandMode, false);
+            settings = getChainSettings (probe.getChainParameters());
+        }
+
+        checkStateRecall (out, { bandMode, 0.0, 0, 0, settings, 0.0 });
+
+        for (auto sampleRate : config.sampleRates)
+        {
+            auto design = CoefficientEngine::designAll (sampleRate, settings);
+            auto tailSamples = 0.0;
+
+            for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+                if ((design.neutralStages & (CoefficientEngine::StageMask (1) << stage)) == 0)
+                    tailSamples += design.stages[(size_t) stage].getDecayLength (CoefficientEngine::tailDecibels);
+
+            tailSamples = juce::jmin (tailSamples, maximumTailSeconds * sampleRate);
+
+            for (auto numChannels : config.channelCounts)
+                for (auto blockSize : config.blockSizes)
+                    runCell (out, { bandMode, sampleRate, blockSize, numChannels, settings, tailSamples });
+        }
+    }
+
+    writeWorst (std::cerr);
+    std::cerr << numFailures << " of " << numChecks << " conformance checks failed" << std::endl;
+    return numFailures;
+}
+
+//==============================================================================
+void ConformanceSuite::runCell (std::ostream& out, const Cell& cell)
+{
+    constexpr TestSignal signals[] = { TestSignal::impulse, TestSignal::sweep, TestSignal::noise };
+    constexpr auto numSignals = std::size (signals);
+
+    std::array<juce::AudioBuffer<double>, numSignals> inputs;
+
+    for (auto signal : signals)
+        inputs[(size_t) signal] = makeSignal (signal, cell);
+
+    // The parallel form only runs on mono, so those paths are skipped elsewhere
+    std::array<std::array<Render, numSignals>, numPaths> renders;
+    std::array<bool, numPaths> ran {};
+
+    for (size_t p = 0; p < numPaths; ++p)
+    {
+        if (paths[p].parallel && cell.numChannels != 1)
+            continue;
+
+        for (auto signal : signals)
+            renders[p][(size_t) signal] = render (paths[p], cell, inputs[(size_t) signal]);
+
+        ran[p] = true;
+    }
+
+    if (config.goldenFolder != juce::File())
+        for (auto signal : signals)
+            writeRow (out, cell, checkGolden (cell, signal, renders[reference][(size_t) signal]));
+
+    // 1/12 octave across the audio band
+    std::vector<double> frequencies;
+
+    for (auto frequency = 20.0; frequency <= juce::jmin (20000.0, 0.45 * cell.sampleRate); frequency *= std::pow (2.0, 1.0 / 12.0))
+        frequencies.push_back (frequency);
+
+    auto designed = designResponse (cell, frequencies);
+    std::array<Response, numPaths> responses;
+
+    for (size_t p = 0; p < numPaths; ++p)
+        if (ran[p])
+            responses[p] = measureResponse (renders[p][(size_t) TestSignal::impulse].output, frequencies, cell.sampleRate);
+
+    auto getNanosecondsPerSample = [&] (size_t p)
+    {
+        auto nanoseconds = 0.0;
+        juce::int64 samples = 0;
+
+        for (auto& r : renders[p])
+        {
+            nanoseconds += r.nanoseconds;
+            samples += r.samples;
+        }
+
+        return samples > 0 ? nanoseconds / (double) samples : 0.0;
+    };
+
+    // What float state costs, which float paths can't be expected to beat
+    std::array<double, numSignals> floatErrors;
+
+    for (auto signal : signals)
+        floatErrors[(size_t) signal] = measureErrorDecibels (renders[floatReference][(size_t) signal].output,
+                                                             renders[reference][(size_t) signal].output);
+
+    auto floatDeviation = compareResponses (responses[floatReference], responses[reference]);
+    auto floatDesignDeviation = compareResponses (responses[floatReference], designed);
+
+    auto widen = [] (Limits limits, double floatError, Deviation floatDeviationToUse)
+    {
+        return Limits { juce::jmax (limits.errorDecibels, floatError + floatMarginDecibels),
+                        juce::jmax (limits.magnitudeDecibels, floatDeviationToUse.magnitudeDecibels * floatMarginFactor),
+                        juce::jmax (limits.phaseDegrees, floatDeviationToUse.phaseDegrees * floatMarginFactor) };
+    };
+
+    for (size_t p = 0; p < numPaths; ++p)
+    {
+        if (! ran[p])
+            continue;
+
+        auto& path = paths[p];
+        auto isFloat = path.precision == Precision::singleFloat;
+        auto nanosecondsPerSample = getNanosecondsPerSample (p);
+        auto speedup = nanosecondsPerSample > 0.0 ? getNanosecondsPerSample ((size_t) path.speedReference) / nanosecondsPerSample : 0.0;
+
+        // The float reference is what the float paths are measured against, so
+        // its own rows are for information
+        auto getResult = [&] (bool passed) { return juce::String (p == floatReference ? "info" : passed ? "pass" : "fail"); };
+
+        if (p != reference)
+        {
+            for (auto signal : signals)
+            {
+                Row row { "reference", path.name, getSignalName (signal) };
+                row.nanosecondsPerSample = nanosecondsPerSample;
+                row.speedup = speedup;
+
+                auto limits = isFloat ? widen (path.limits, floatErrors[(size_t) signal], floatDeviation) : path.limits;
+                row.errorDecibels = measureErrorDecibels (renders[p][(size_t) signal].output, renders[reference][(size_t) signal].output);
+                auto passed = row.errorDecibels <= limits.errorDecibels;
+
+                if (signal == TestSignal::impulse)
+                {
+                    auto deviation = compareResponses (responses[p], responses[reference]);
+                    row.magnitudeDecibels = deviation.magnitudeDecibels;
+                    row.phaseDegrees = deviation.phaseDegrees;
+                    passed = passed && deviation.magnitudeDecibels <= limits.magnitudeDecibels
+                                    && deviation.phaseDegrees <= limits.phaseDegrees;
+                }
+
+                row.result = getResult (passed);
+                writeRow (out, cell, row);
+            }
+        }
+
+        {
+            Row row { "response", path.name, getSignalName (TestSignal::impulse) };
+            row.nanosecondsPerSample = nanosecondsPerSample;
+            row.speedup = speedup;
+
+            auto limits = isFloat ? widen (path.limits, 0.0, floatDesignDeviation) : path.limits;
+            auto deviation = compareResponses (responses[p], designed);
+            row.magnitudeDecibels = deviation.magnitudeDecibels;
+            row.phaseDegrees = deviation.phaseDegrees;
+            row.result = getResult (deviation.magnitudeDecibels <= limits.magnitudeDecibels
+                                     && deviation.phaseDegrees <= limits.phaseDegrees);
+            writeRow (out, cell, row);
+        }
+
+        {
+            Row row { "speed", path.name };
+            row.nanosecondsPerSample = nanosecondsPerSample;
+            row.speedup = speedup;
+            row.result = path.forSpeed && config.minimumSpeedup > 0.0 ? (speedup >= config.minimumSpeedup ? "pass" : "fail")
+                                                                      : "info";
+            writeRow (out, cell, row);
+        }
+    }
+
+    if (cell.numChannels == 1)
+        checkBandChange (out, cell);
+}
+
+void ConformanceSuite::checkStateRecall (std::ostream& out, const Cell& cell)
+{
+    // The DSP, the designers and the editor all read the values the APVTS
+    // mirrors from each parameter, so those are what a restore has to reach
+    auto getRawValues = [] (GraphicEqAudioProcessor& processor)
+    {
+        std::vector<float> values;
+
+        for (auto* parameter : PluginState::getStateParameters (processor.apvts))
+            values.push_back (processor.apvts.getRawParameterValue (parameter->paramID)->load());
+
+        return values;
+    };
+
+    auto matches = [] (const std::vector<float>& values, const std::vector<float>& expected)
+    {
+        if (values.size() != expected.size())
+            return false;
+
+        for (size_t i = 0; i < values.size(); ++i)
+            if (std::abs (values[i] - expected[i]) > 1.0e-4f * juce::jmax (1.0f, std::abs (expected[i])))
+                return false;
+
+        return true;
+    };
+
+    GraphicEqAudioProcessor source;
+    applyTestCurve (source.apvts, cell.bandMode, false);
+    auto expected = getRawValues (source);
+
+    juce::MemoryBlock state;
+    source.getStateInformation (state);
+
+    {
+        GraphicEqAudioProcessor restored;
+        restored.setStateInformation (state.getData(), (int) state.getSize());
+
+        Row row { "state", "setStateInformation" };
+        row.result = matches (getRawValues (restored), expected) ? "pass" : "fail";
+        writeRow (out, cell, row);
+    }
+
+    {
+        // Stored as a snapshot, then flattened, then picked as a program
+        source.getSnapshotBank().store (1);
+        applyTestCurve (source.apvts, cell.bandMode, true);
+        source.setCurrentProgram (1);
+
+        Row row { "state", "setCurrentProgram" };
+        row.result = matches (getRawValues (source), expected) ? "pass" : "fail";
+        writeRow (out, cell, row);
+    }
+}
+
+void ConformanceSuite::checkBandChange (std::ostream& out, const Cell& cell)
+{
+    // Noise throughout, with the bands moved a quarter of a second in. Until
+    // the switch is over the paths may differ, as the cascade ramps while the
+    // parallel form cross-fades, so that part is only reported; after it, and
+    // twice the tail, neither remembers how it got there.
+    auto changeSample = (int) (0.25 * cell.sampleRate);
+    auto settledSample = changeSample + (int) std::ceil (switchSeconds * cell.sampleRate + 2.0 * cell.tailSamples);
+
+    juce::AudioBuffer<double> noise (1, settledSample + (int) (0.25 * cell.sampleRate));
+    juce::Random random (3);
+
+    for (int i = 0; i < noise.getNumSamples(); ++i)
+        noise.setSample (0, i, random.nextDouble() * 0.5 - 0.25);
+
+    auto expected = render (paths[reference], cell, noise, changeSample);
+    auto floatReferenceRender = render (paths[floatReference], cell, noise, changeSample);
+    auto floatError = measureErrorDecibels (floatReferenceRender.output, expected.output, settledSample);
+
+    for (auto& path : paths)
+    {
+        if (! path.parallel)
+            continue;
+
+        auto rendered = render (path, cell, noise, changeSample);
+
+        Row transition { "bandChange", path.name, "transition" };
+        transition.errorDecibels = measureErrorDecibels (rendered.output, expected.output, changeSample, settledSample);
+        writeRow (out, cell, transition);
+
+        auto limit = path.limits.errorDecibels;
+
+        if (path.precision == Precision::singleFloat)
+            limit = juce::jmax (limit, floatError + floatMarginDecibels);
+
+        Row settled { "bandChange", path.name, "settled" };
+        settled.errorDecibels = measureErrorDecibels (rendered.output, expected.output, settledSample);
+        settled.result = settled.errorDecibels <= limit ? "pass" : "fail";
+        writeRow (out, cell, settled);
+    }
+}
+
+//==============================================================================
+ConformanceSuite::Render ConformanceSuite::render (const Path& path, const Cell& cell, const juce::AudioBuffer<double>& signal, int changeSample) const
+{
+    using namespace BenchmarkHelpers;
+
+    GraphicEqAudioProcessor processor;
+    Render result;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add (juce::AudioChannelSet::canonicalChannelSet (cell.numChannels));
+    layout.outputBuses.add (juce::AudioChannelSet::canonicalChannelSet (cell.numChannels));
+
+    if (! processor.setBusesLayout (layout))
+        return result;
+
+    // Pin everything that would take another path
+    setParameter (processor.apvts, "Engine", (float) path.engine);
+    setParameter (processor.apvts, "Smoothing", (float) path.smoothing);
+    setParameter (processor.apvts, "HighPrecision", path.precision == Precision::highPrecision ? 1.0f : 0.0f);
+    setParameter (processor.apvts, "Parallel", path.parallel ? 1.0f : 0.0f);
+    setParameter (processor.apvts, "LinearPhase", 0.0f);
+    setParameter (processor.apvts, "Oversampling", 0.0f);
+    setParameter (processor.apvts, "Compensation", 0.0f);
+
+    // A smoothed path starts flat and ramps to the curve in the pre-roll; the
+    // others have it from prepareToPlay, which also expands the parallel form
+    applyTestCurve (processor.apvts, cell.bandMode, path.smoothing > 0);
+
+    processor.setProcessingPrecision (path.precision == Precision::doubleFloat ? juce::AudioProcessor::doublePrecision
+                                                                                : juce::AudioProcessor::singlePrecision);
+    processor.setNonRealtime (true);
+    processor.setRateAndBufferSizeDetails (cell.sampleRate, cell.blockSize);
+    processor.prepareToPlay (cell.sampleRate, cell.blockSize);
+
+    if (path.smoothing > 0)
+        applyTestCurve (processor.apvts, cell.bandMode, false);
+
+    // Noise while the ramp runs, then silence for twice the tail, which leaves
+    // whatever the pre-roll left ringing 200 dB down. Every path gets the same
+    // input, smoothed or not.
+    auto rampSamples = (int) std::ceil (2.0 * CoefficientEngine::smoothingTimeSeconds * cell.sampleRate);
+    auto preRollSamples = rampSamples + (int) std::ceil (2.0 * cell.tailSamples);
+    preRollSamples = (preRollSamples + cell.blockSize - 1) / cell.blockSize * cell.blockSize;
+
+    juce::AudioBuffer<double> input (cell.numChannels, preRollSamples + signal.getNumSamples());
+    input.clear();
+    juce::Random random (2);
+
+    for (int channel = 0; channel < cell.numChannels; ++channel)
+    {
+        for (int i = 0; i < rampSamples; ++i)
+            input.setSample (channel, i, random.nextDouble() * 0.5 - 0.25);
+
+        input.copyFrom (channel, preRollSamples, signal, channel, 0, signal.getNumSamples());
+    }
+
+    // Offline, the background thread could expand the moved bands at any block;
+    // this way every render switches at the same one
+    auto moveBands = [&processor, &cell]
+    {
+        moveTestCurve (processor.apvts, cell.bandMode);
+        processor.getParallelEq().update();
+    };
+    auto changeAt = changeSample >= 0 ? preRollSamples + changeSample : -1;
+
+    if (path.precision == Precision::doubleFloat)
+        processBlocks<double> (processor, input, preRollSamples, cell.blockSize, result, changeAt, moveBands);
+    else
+        processBlocks<float> (processor, input, preRollSamples, cell.blockSize, result, changeAt, moveBands);
+
+    processor.releaseResources();
+    return result;
+}
+
+template <typename SampleType>
+void ConformanceSuite::processBlocks (GraphicEqAudioProcessor& processor, const juce::AudioBuffer<double>& input,
+                                      int firstTimedSample, int blockSize, Render& render,
+                                      int changeSample, const std::function<void()>& change)
+{
+    auto numChannels = input.getNumChannels();
+    juce::AudioBuffer<SampleType> buffer (numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    render.output.setSize (numChannels, input.getNumSamples() - firstTimedSample);
+
+    for (int start = 0; start < input.getNumSamples(); start += blockSize)
+    {
+        auto numSamples = juce::jmin (blockSize, input.getNumSamples() - start);
+        buffer.setSize (numChannels, numSamples, false, false, true);
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                buffer.setSample (channel, i, (SampleType) input.getSample (channel, start + i));
+
+        if (changeSample >= 0 && start >= changeSample && start - blockSize < changeSample && change != nullptr)
+            change();
+
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        processor.processBlock (buffer, midi);
+        auto elapsed = juce::Time::getHighResolutionTicks() - startTicks;
+
+        // The pre-roll is whole blocks, so a block is either all in it or all out
+        if (start < firstTimedSample)
+            continue;
+
+        render.nanoseconds += BenchmarkHelpers::ticksToNanoseconds (elapsed);
+        render.samples += numSamples;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                render.output.setSample (channel, start - firstTimedSample + i, (double) buffer.getSample (channel, i));
+    }
+}
+
+//==============================================================================
+ConformanceSuite::Row ConformanceSuite::checkGolden (const Cell& cell, TestSignal signal, const Render& render)
+{
+    Row row { "golden", paths[reference].name, getSignalName (signal) };
+
+    auto file = config.goldenFolder.getChildFile (juce::String (getBandTable (cell.bandMode).numBands) + "bands_"
+                                                  + juce::String (juce::roundToInt (cell.sampleRate)) + "Hz_"
+                                                  + juce::String (cell.numChannels) + "ch_"
+                                                  + getSignalName (signal) + ".wav");
+
+    // Written once per run at most; the other block sizes are then held to it
+    if ((config.updateGolden || ! file.existsAsFile()) && ! goldenWritten.contains (file.getFullPathName()))
+    {
+        juce::AudioBuffer<float> samples;
+        samples.makeCopyOf (render.output);
+
+        file.getParentDirectory().createDirectory();
+        file.deleteFile();
+
+        juce::WavAudioFormat wav;
+        auto stream = file.createOutputStream();
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (stream != nullptr && stream->openedOk())
+            writer.reset (wav.createWriterFor (stream.get(), cell.sampleRate, (unsigned int) cell.numChannels, 32, {}, 0));
+
+        if (writer == nullptr || samples.getNumChannels() == 0)
+        {
+            row.result = "fail";
+            return row;
+        }
+
+        stream.release();   // the writer owns it now
+
+        row.result = writer->writeFromAudioSampleBuffer (samples, 0, samples.getNumSamples()) ? "written" : "fail";
+        goldenWritten.add (file.getFullPathName());
+        return row;
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (file));
+
+    if (reader == nullptr || (int) reader->numChannels != render.output.getNumChannels()
+         || reader->lengthInSamples != render.output.getNumSamples())
+    {
+        row.result = "fail";
+        return row;
+    }
+
+    juce::AudioBuffer<float> golden ((int) reader->numChannels, (int) reader->lengthInSamples);
+    reader->read (&golden, 0, golden.getNumSamples(), 0, true, true);
+
+    juce::AudioBuffer<double> expected;
+    expected.makeCopyOf (golden);
+
+    row.errorDecibels = measureErrorDecibels (render.output, expected);
+    row.result = row.errorDecibels <= goldenErrorDecibels ? "pass" : "fail";
+    return row;
+}
+
+//==============================================================================
+juce::AudioBuffer<double> ConformanceSuite::makeSignal (TestSignal signal, const Cell& cell)
+{
+    auto sampleRate = cell.sampleRate;
+
+    // The impulse runs for twice the tail, so its response is cut off 200 dB down
+    auto length = signal == TestSignal::impulse ? juce::jmax ((int) std::ceil (2.0 * cell.tailSamples), (int) (0.25 * sampleRate))
+                                                : (int) sampleRate;
+
+    juce::AudioBuffer<double> buffer (cell.numChannels, length);
+    buffer.clear();
+    juce::Random random (1);
+
+    for (int channel = 0; channel < cell.numChannels; ++channel)
+    {
+        auto* samples = buffer.getWritePointer (channel);
+
+        switch (signal)
+        {
+            case TestSignal::impulse:
+                samples[0] = 1.0;
+                break;
+
+            case TestSignal::sweep:
+            {
+                // Exponential, from 20 Hz to just below Nyquist
+                auto startFrequency = 20.0;
+                auto rate = std::log (0.45 * sampleRate / startFrequency);
+                auto seconds = (double) length / sampleRate;
+
+                for (int i = 0; i < length; ++i)
+                {
+                    auto phase = juce::MathConstants<double>::twoPi * startFrequency * seconds / rate
+                                   * (std::exp (rate * (double) i / (double) length) - 1.0);
+                    samples[i] = 0.5 * std::sin (phase);
+                }
+
+                break;
+            }
+
+            case TestSignal::noise:
+            default:
+                for (int i = 0; i < length; ++i)
+                    samples[i] = random.nextDouble() * 0.5 - 0.25;
+
+                break;
+        }
+    }
+
+    return buffer;
+}
+
+juce::String ConformanceSuite::getSignalName (TestSignal signal)
+{
+    switch (signal)
+    {
+        case TestSignal::impulse:  return "impulse";
+        case TestSignal::sweep:    return "sweep";
+        case TestSignal::noise:
+        default:                   return "noise";
+    }
+}
+
+void ConformanceSuite::applyTestCurve (juce::AudioProcessorValueTreeState& apvts, BandMode bandMode, bool flat)
+{
+    using namespace BenchmarkHelpers;
+
+    // Steep cuts near both ends and every fourth band left flat, so each kind
+    // of stage is exercised, neutral ones too. Flat keeps the slopes and
+    // alignments, which would otherwise land in one step instead of ramping.
+    resetParameters (apvts, bandMode);
+    setParameter (apvts, "LowCutSlope", 1.0f);
+    setParameter (apvts, "LowCutType", (float) CutType::butterworth);
+    setParameter (apvts, "HiCutSlope", 1.0f);
+    setParameter (apvts, "HiCutType", (float) CutType::linkwitzRiley);
+
+    if (flat)
+        return;
+
+    setParameter (apvts, "LowCut", 30.0f);
+    setParameter (apvts, "HiCut", 15000.0f);
+
+    auto bands = getBandTable (bandMode);
+    juce::Random random (bands.numBands);
+
+    for (int band = 0; band < bands.numBands; ++band)
+        setParameter (apvts, bands.bands[band].parameterID, band % 4 == 3 ? 0.0f : 24.0f * random.nextFloat() - 12.0f);
+}
+
+void ConformanceSuite::moveTestCurve (juce::AudioProcessorValueTreeState& apvts, BandMode bandMode)
+{
+    using namespace BenchmarkHelpers;
+
+    // The flat bands stay flat, so the stages that are neutral don't change
+    auto bands = getBandTable (bandMode);
+    juce::Random random (bands.numBands + 1);
+
+    for (int band = 0; band < bands.numBands; ++band)
+        if (band % 4 != 3)
+            setParameter (apvts, bands.bands[band].parameterID, 24.0f * random.nextFloat() - 12.0f);
+}
+
+//==============================================================================
+double ConformanceSuite::measureErrorDecibels (const juce::AudioBuffer<double>& output, const juce::AudioBuffer<double>& expected,
+                                               int startSample, int endSample)
+{
+    auto numChannels = juce::jmin (output.getNumChannels(), expected.getNumChannels());
+    auto numSamples = juce::jmin (output.getNumSamples(), expected.getNumSamples(), endSample);
+
+    if (numChannels == 0 || numSamples <= startSample)
+        return std::numeric_limits<double>::infinity();
+
+    auto error = 0.0, peak = 0.0;
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        for (int i = startSample; i < numSamples; ++i)
+        {
+            error = juce::jmax (error, std::abs (output.getSample (channel, i) - expected.getSample (channel, i)));
+            peak = juce::jmax (peak, std::abs (expected.getSample (channel, i)));
+        }
+    }
+
+    // Relative to the expected peak; identical renders come out at -400
+    return juce::Decibels::gainToDecibels (error / juce::jmax (peak, 1.0e-30), -400.0);
+}
+
+ConformanceSuite::Response ConformanceSuite::measureResponse (const juce::AudioBuffer<double>& impulseResponse,
+                                                              const std::vector<double>& frequencies, double sampleRate)
+{
+    Response response (frequencies.size());
+
+    if (impulseResponse.getNumChannels() == 0)
+        return response;
+
+    // The channels are linked, so the first stands for them all
+    auto* samples = impulseResponse.getReadPointer (0);
+
+    for (size_t f = 0; f < frequencies.size(); ++f)
+    {
+        // A rotating phasor rather than trig per sample; over a few seconds its
+        // drift stays far below anything the limits can see
+        auto step = std::polar (1.0, -juce::MathConstants<double>::twoPi * frequencies[f] / sampleRate);
+        std::complex<double> phasor (1.0), sum;
+
+        for (int i = 0; i < impulseResponse.getNumSamples(); ++i)
+        {
+            sum += samples[i] * phasor;
+            phasor *= step;
+        }
+
+        response[f] = sum;
+    }
+
+    return response;
+}
+
+ConformanceSuite::Response ConformanceSuite::designResponse (const Cell& cell, const std::vector<double>& frequencies)
+{
+    auto design = CoefficientEngine::designAll (cell.sampleRate, cell.settings);
+    Response response;
+
+    for (auto frequency : frequencies)
+    {
+        auto z1 = std::polar (1.0, -juce::MathConstants<double>::twoPi * frequency / cell.sampleRate);
+        std::complex<double> product (1.0);
+
+        for (int stage = 0; stage < ChainPositions::numChainStages; ++stage)
+            if ((design.neutralStages & (CoefficientEngine::StageMask (1) << stage)) == 0)
+                product *= design.stages[(size_t) stage].getResponse (z1);
+
+        response.push_back (product);
+    }
+
+    return response;
+}
+
+ConformanceSuite::Deviation ConformanceSuite::compareResponses (const Response& measured, const Response& expected)
+{
+    auto peak = 0.0;
+
+    for (auto& value : expected)
+        peak = juce::jmax (peak, std::abs (value));
+
+    // Only within 60 dB of the peak; further down, rounding in the renders is all there is to see
+    Deviation deviation;
+
+    for (size_t i = 0; i < juce::jmin (measured.size(), expected.size()); ++i)
+    {
+        if (std::abs (expected[i]) < peak * 1.0e-3)
+            continue;
+
+        auto ratio = measured[i] / expected[i];
+        deviation.magnitudeDecibels = juce::jmax (deviation.magnitudeDecibels, std::abs (20.0 * std::log10 (std::abs (ratio))));
+        deviation.phaseDegrees = juce::jmax (deviation.phaseDegrees, juce::radiansToDegrees (std::abs (std::arg (ratio))));
+    }
+
+    return deviation;
+}
+
+//==============================================================================
+void ConformanceSuite::writeWorst (std::ostream& out) const
+{
+    out << "worst over the run:" << std::endl;
+
+    for (auto& [name, entry] : worst)
+        out << "  " << name << ": error " << juce::String (entry.errorDecibels, 1) << " dB, magnitude "
+            << juce::String (entry.magnitudeDecibels, 6) << " dB, phase " << juce::String (entry.phaseDegrees, 6)
+            << " degrees" << std::endl;
+}
+
+void ConformanceSuite::writeRow (std::ostream& out, const Cell& cell, const Row& row)
+{
+    auto format = [] (double value, int decimals) { return std::isnan (value) ? juce::String ("-") : juce::String (value, decimals); };
+
+    juce::StringArray columns { row.check, row.path, juce::String (getBandTable (cell.bandMode).numBands), row.signal,
+                                juce::String (cell.sampleRate), juce::String (cell.blockSize), juce::String (cell.numChannels),
+                                format (row.errorDecibels, 1), format (row.magnitudeDecibels, 6), format (row.phaseDegrees, 6),
+                                juce::String (row.nanosecondsPerSample, 3), juce::String (row.speedup, 3), row.result };
+
+    out << columns.joinIntoString (",") << std::endl;
+
+    if (! (std::isnan (row.errorDecibels) && std::isnan (row.magnitudeDecibels) && std::isnan (row.phaseDegrees)))
+    {
+        // NaN compares false, so an unmeasured value leaves its worst alone
+        auto& entry = worst[(row.check + " " + row.path + " " + row.signal).toStdString()];
+        entry.errorDecibels = juce::jmax (entry.errorDecibels, row.errorDecibels);
+        entry.magnitudeDecibels = juce::jmax (entry.magnitudeDecibels, row.magnitudeDecibels);
+        entry.phaseDegrees = juce::jmax (entry.phaseDegrees, row.phaseDegrees);
+    }
+
+    if (row.result == "pass" || row.result == "fail")
+        ++numChecks;
+
+    if (row.result == "fail")
+    {
+        ++numFailures;
+        std::cerr << "failed: " << row.check << " " << row.path << " " << row.signal << " at " << cell.sampleRate
+                  << " Hz, block " << cell.blockSize << ", " << cell.numChannels << " channels" << std::endl;
+    }
+}
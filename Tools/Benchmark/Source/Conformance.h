@@ -0,0 +1,196 @@
+/*
+  ==============================================================================
+
+    Conformance.h
+
+    Checks that every alternative path through processBlock sounds like the
+    MonoChain reference. Fixed test signals (an impulse, a sine sweep and
+    noise) are rendered through the scalar engine in double precision, the
+    reference, and through each other path: the SIMD engine, the parallel
+    form, high precision state, sub-block smoothing and the float versions of
+    all of them. Each is compared with the reference sample by sample and,
+    from the impulse, in magnitude and phase over the audio band, and every
+    impulse response is also held to the response ChainSettings designs.
+
+    On mono, the parallel paths are also rendered through a change of every
+    band part way through noise, and once they have switched to the new
+    expansion they must sound like the reference again.
+
+    A float cascade rounds its state enough that at high rates its low bands
+    are audibly off, whichever engine runs it, so float paths are held to no
+    worse than the float reference rather than to fixed limits. Every row
+    also carries the path's speed against the one it replaces.
+
+    The double reference renders can be kept as golden files, so later builds
+    are held to this one too. Restoring saved state and picking a program are
+    also checked to reach the parameter values the DSP reads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+struct ConformanceConfig
+{
+    juce::Array<int> blockSizes { 32, 441, 4096 };
+    juce::Array<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+    juce::Array<int> channelCounts { 1, 2 };
+    juce::Array<BandMode> bandModes { BandMode::octave, BandMode::thirdOctave };
+
+    /** Where the golden renders are kept; none are read or written if this isn't set. */
+    juce::File goldenFolder;
+
+    /** Rewrites the golden renders from this build instead of checking against them. */
+    bool updateGolden = false;
+
+    /** The paths that exist to be faster fail if they are slower than this
+        against the path they replace; 0 leaves speed unchecked. */
+    double minimumSpeedup = 0.0;
+};
+
+//==============================================================================
+class ConformanceSuite
+{
+public:
+    explicit ConformanceSuite (ConformanceConfig configToUse);
+
+    /** Runs every check, writing the CSV header and a row per comparison, and
+        returns how many failed. */
+    int run (std::ostream& out);
+
+    static juce::StringArray getColumnNames();
+
+private:
+    //==============================================================================
+    enum class Precision
+    {
+        singleFloat,    // float buffers and filter state
+        doubleFloat,    // double buffers and filter state
+        highPrecision   // float buffers, double filter state
+    };
+
+    enum class TestSignal
+    {
+        impulse,
+        sweep,
+        noise
+    };
+
+    /** Largest differences a path may show from the reference. */
+    struct Limits
+    {
+        double errorDecibels, magnitudeDecibels, phaseDegrees;
+    };
+
+    /** One way through processBlock. */
+    struct Path
+    {
+        const char* name;
+        GraphicEqAudioProcessor::ProcessingEngine engine;
+        Precision precision;
+        bool parallel;
+        int smoothing;          // the Smoothing parameter's choice, 0 for off
+        int speedReference;     // the path this one would replace, for the speedup
+        bool forSpeed;          // exists to be faster, so minimumSpeedup applies
+        Limits limits;          // widened to the float reference's for float paths
+    };
+
+    /** The settings every path is rendered with. */
+    struct Cell
+    {
+        BandMode bandMode;
+        double sampleRate;
+        int blockSize, numChannels;
+        ChainSettings settings;
+        double tailSamples;
+    };
+
+    struct Render
+    {
+        juce::AudioBuffer<double> output;
+        double nanoseconds = 0.0;
+        juce::int64 samples = 0;
+    };
+
+    static constexpr double notMeasured = std::numeric_limits<double>::quiet_NaN();
+
+    struct Row
+    {
+        juce::String check, path, signal = "-";
+        double errorDecibels = notMeasured, magnitudeDecibels = notMeasured, phaseDegrees = notMeasured;
+        double nanosecondsPerSample = 0.0, speedup = 0.0;
+        juce::String result = "info";
+    };
+
+    struct Deviation
+    {
+        double magnitudeDecibels = 0.0, phaseDegrees = 0.0;
+    };
+
+    using Response = std::vector<std::complex<double>>;
+
+    static constexpr size_t numPaths = 9;
+    static const Path paths[numPaths];
+
+    /** The float and double MonoChain paths, first in the table. */
+    static constexpr size_t floatReference = 0, reference = 1;
+
+    //==============================================================================
+    void runCell (std::ostream& out, const Cell& cell);
+
+    /** Restores the test curve from saved state, and recalls it as a program,
+        checking that the values the DSP reads have followed. */
+    void checkStateRecall (std::ostream& out, const Cell& cell);
+
+    /** Renders noise through the parallel paths and the references with every
+        band moved part way, comparing what follows once the switch is over. */
+    void checkBandChange (std::ostream& out, const Cell& cell);
+
+    /** Renders a signal after a pre-roll of noise and silence, long enough for
+        a smoothed path to have landed on the curve and forgotten it. With a
+        changeSample, the bands are moved at the first block from there on. */
+    Render render (const Path& path, const Cell& cell, const juce::AudioBuffer<double>& signal, int changeSample = -1) const;
+
+    template <typename SampleType>
+    static void processBlocks (GraphicEqAudioProcessor& processor, const juce::AudioBuffer<double>& input,
+                               int firstTimedSample, int blockSize, Render& render,
+                               int changeSample = -1, const std::function<void()>& change = nullptr);
+
+    /** Compares a reference render with its golden file, writing the file if
+        it is missing or being updated. */
+    Row checkGolden (const Cell& cell, TestSignal signal, const Render& render);
+
+    static juce::AudioBuffer<double> makeSignal (TestSignal signal, const Cell& cell);
+    static juce::String getSignalName (TestSignal signal);
+    static void applyTestCurve (juce::AudioProcessorValueTreeState& apvts, BandMode bandMode, bool flat);
+
+    /** Gives every band of the test curve a new gain, as automation would. */
+    static void moveTestCurve (juce::AudioProcessorValueTreeState& apvts, BandMode bandMode);
+
+    static double measureErrorDecibels (const juce::AudioBuffer<double>& output, const juce::AudioBuffer<double>& expected,
+                                        int startSample = 0, int endSample = std::numeric_limits<int>::max());
+    static Response measureResponse (const juce::AudioBuffer<double>& impulseResponse, const std::vector<double>& frequencies, double sampleRate);
+    static Response designResponse (const Cell& cell, const std::vector<double>& frequencies);
+    static Deviation compareResponses (const Response& measured, const Response& expected);
+
+    void writeRow (std::ostream& out, const Cell& cell, const Row& row);
+
+    /** The worst of each measurement over the run, per check, path and
+        signal, which is what the limits should be set from. */
+    struct Worst
+    {
+        double errorDecibels = -400.0, magnitudeDecibels = 0.0, phaseDegrees = 0.0;
+    };
+
+    void writeWorst (std::ostream& out) const;
+
+    ConformanceConfig config;
+    juce::AudioFormatManager formats;
+    juce::StringArray goldenWritten;
+    std::map<std::string, Worst> worst;
+    int numChecks = 0, numFailures = 0;
+};
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Command line front end for BenchmarkSuite and ConformanceSuite:
+
+        GraphicEqBenchmark [--quick] [--block-sizes=16,64] [--rates=48000] [--channels=2]
+                           [--bands=10,31] [--tracks=128] [--threads=1,4] [--seconds=1.0]
+                           [--output=results.csv]
+
+        GraphicEqBenchmark --conformance [--quick] [--block-sizes=32,441] [--rates=48000]
+                           [--channels=1,2] [--bands=10,31] [--golden=folder] [--update-golden]
+                           [--min-speedup=1.0] [--output=results.csv]
+
+    Results are CSV, on stdout unless --output is given. The conformance run
+    exits with 1 if any check failed, and lists the worst of every measurement
+    on stderr, which is what its limits are set from.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "Benchmarks.h"
+#include "Conformance.h"
+
+#include <fstream>
+
+namespace
+{
+    template <typename ValueType>
+    juce::Array<ValueType> parseList (const juce::String& text)
+    {
+        juce::Array<ValueType> values;
+
+        for (auto& token : juce::StringArray::fromTokens (text, ",", {}))
+            values.add ((ValueType) token.trim().getDoubleValue());
+
+        return values;
+    }
+
+    /** The options both suites share. */
+    template <typename ConfigType>
+    void parseCommonOptions (const juce::ArgumentList& args, ConfigType& config)
+    {
+        if (args.containsOption ("--block-sizes"))   config.blockSizes = parseList<int> (args.getValueForOption ("--block-sizes"));
+        if (args.containsOption ("--rates"))         config.sampleRates = parseList<double> (args.getValueForOption ("--rates"));
+        if (args.containsOption ("--channels"))      config.channelCounts = parseList<int> (args.getValueForOption ("--channels"));
+
+        if (args.containsOption ("--bands"))
+        {
+            config.bandModes.clear();
+
+            for (auto numBands : parseList<int> (args.getValueForOption ("--bands")))
+                config.bandModes.add (numBands == numThirdOctaveBands ? BandMode::thirdOctave : BandMode::octave);
+        }
+    }
+
+    template <typename SuiteType>
+    auto runSuite (const juce::ArgumentList& args, SuiteType& suite)
+    {
+        if (args.containsOption ("--output"))
+        {
+            std::ofstream file (args.getFileForOption ("--output").getFullPathName().toStdString());
+            return suite.run (file);
+        }
+
+        return suite.run (std::cout);
+    }
+
+    int runConformance (const juce::ArgumentList& args)
+    {
+        ConformanceConfig config;
+
+        if (args.containsOption ("--quick"))
+        {
+            config.blockSizes = { 64, 441 };
+            config.sampleRates = { 48000.0 };
+        }
+
+        parseCommonOptions (args, config);
+
+        if (args.containsOption ("--golden"))        config.goldenFolder = args.getFileForOption ("--golden");
+        if (args.containsOption ("--min-speedup"))   config.minimumSpeedup = args.getValueForOption ("--min-speedup").getDoubleValue();
+
+        config.updateGolden = args.containsOption ("--update-golden");
+
+        ConformanceSuite suite (std::move (config));
+        return runSuite (args, suite) == 0 ? 0 : 1;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.containsOption ("--help|-h"))
+    {
+        std::cout << "Usage: " << args.executableName
+                  << " [--quick] [--block-sizes=a,b] [--rates=a,b] [--channels=a,b] [--bands=10,31]"
+                  << " [--tracks=a,b] [--threads=a,b] [--seconds=s] [--output=file.csv]" << std::endl
+                  << "       " << args.executableName
+                  << " --conformance [--quick] [--block-sizes=a,b] [--rates=a,b] [--channels=a,b] [--bands=10,31]"
+                  << " [--golden=folder] [--update-golden] [--min-speedup=x] [--output=file.csv]" << std::endl;
+        return 0;
+    }
+
+    if (args.containsOption ("--conformance"))
+        return runConformance (args);
+
+    BenchmarkConfig config;
+
+    if (args.containsOption ("--quick"))
+    {
+        config.blockSizes = { 64, 512 };
+        config.sampleRates = { 48000.0 };
+        config.channelCounts = { 2 };
+        config.trackCounts = { 16 };
+        config.threadCounts = { 1, 2 };
+        config.secondsPerRun = 0.25;
+        config.iterations = 2000;
+    }
+
+    parseCommonOptions (args, config);
+
+    if (args.containsOption ("--tracks"))        config.trackCounts = parseList<int> (args.getValueForOption ("--tracks"));
+    if (args.containsOption ("--threads"))       config.threadCounts = parseList<int> (args.getValueForOption ("--threads"));
+    if (args.containsOption ("--seconds"))       config.secondsPerRun = args.getValueForOption ("--seconds").getDoubleValue();
+
+    BenchmarkSuite suite (std::move (config));
+    runSuite (args, suite);
+    return 0;
+}
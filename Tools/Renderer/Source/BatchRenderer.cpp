@@ -0,0 +1,205 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.cpp
+
+  ==============================================================================
+*/
+
+#include "BatchRenderer.h"
+
+//==============================================================================
+class BatchRenderer::Worker  : public juce::Thread
+{
+public:
+    Worker (BatchRenderer& ownerToUse, int index)
+        : juce::Thread ("Render worker " + juce::String (index)),
+          owner (ownerToUse)
+    {
+        formats.registerBasicFormats();
+    }
+
+    ~Worker() override
+    {
+        stopThread (-1);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            auto index = owner.nextTask++;
+
+            if (index >= owner.tasks.size())
+                break;
+
+            auto& task = owner.tasks.getReference (index);
+            owner.report (task, owner.renderFile (processor, formats, task));
+        }
+    }
+
+private:
+    BatchRenderer& owner;
+    juce::AudioFormatManager formats;
+    GraphicEqAudioProcessor processor;
+};
+
+//==============================================================================
+BatchRenderer::BatchRenderer (RenderOptions optionsToUse)
+    : options (std::move (optionsToUse))
+{
+    formatManager.registerBasicFormats();
+}
+
+BatchRenderer::~BatchRenderer() = default;
+
+void BatchRenderer::addInput (const juce::File& fileOrFolder)
+{
+    if (! fileOrFolder.isDirectory())
+    {
+        addTask ({ fileOrFolder, options.outputFolder.getChildFile (fileOrFolder.getFileName()) });
+        return;
+    }
+
+    auto wildcard = formatManager.getWildcardForAllFormats();
+
+    for (auto& file : fileOrFolder.findChildFiles (juce::File::findFiles, true, wildcard))
+    {
+        // An output folder inside the scanned one holds earlier renders, not inputs
+        if (file.isAChildOf (options.outputFolder))
+            continue;
+
+        addTask ({ file, options.outputFolder.getChildFile (file.getRelativePathFrom (fileOrFolder)) });
+    }
+}
+
+void BatchRenderer::addTask (const Task& task)
+{
+    // The output is deleted and rewritten while the input is still being read
+    if (task.output == task.input)
+    {
+        std::cerr << "skipped " << task.input.getFullPathName() << ": the output would overwrite it" << std::endl;
+        return;
+    }
+
+    tasks.add (task);
+}
+
+int BatchRenderer::run()
+{
+    nextTask = 0;
+    numFailures = 0;
+
+    juce::OwnedArray<Worker> workers;
+
+    for (int i = 0; i < juce::jlimit (1, juce::jmax (1, tasks.size()), options.numThreads); ++i)
+        workers.add (new Worker (*this, i))->startThread();
+
+    for (auto* worker : workers)
+        while (worker->isThreadRunning())
+            worker->wait (100);
+
+    return numFailures.load();
+}
+
+//==============================================================================
+juce::Result BatchRenderer::renderFile (GraphicEqAudioProcessor& processor, juce::AudioFormatManager& formats,
+                                        const Task& task) const
+{
+    std::unique_ptr<juce::AudioFormatReader> reader (formats.createReaderFor (task.input));
+
+    if (reader == nullptr)
+        return juce::Result::fail ("can't read this file");
+
+    auto numChannels = (int) reader->numChannels;
+    auto sampleRate = reader->sampleRate;
+    auto blockSize = options.blockSize;
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+    layout.outputBuses.add (juce::AudioChannelSet::canonicalChannelSet (numChannels));
+
+    if (! processor.setBusesLayout (layout))
+        return juce::Result::fail ("unsupported channel count " + juce::String (numChannels));
+
+    // Restore the preset before preparing, so the first block already uses it
+    processor.setStateInformation (options.state.getData(), (int) options.state.getSize());
+    processor.setNonRealtime (true);
+    processor.prepareToPlay (sampleRate, blockSize);
+
+    auto* format = formats.findFormatForFileExtension (task.output.getFileExtension());
+
+    if (format == nullptr)
+        return juce::Result::fail ("no writer for " + task.output.getFileExtension());
+
+    auto bitDepths = format->getPossibleBitDepths();
+    auto bitsPerSample = (int) reader->bitsPerSample;
+
+    if (! bitDepths.contains (bitsPerSample))
+        bitsPerSample = bitDepths.getLast();
+
+    task.output.getParentDirectory().createDirectory();
+    task.output.deleteFile();
+
+    auto stream = task.output.createOutputStream();
+
+    if (stream == nullptr || ! stream->openedOk())
+        return juce::Result::fail ("can't write " + task.output.getFullPathName());
+
+    std::unique_ptr<juce::AudioFormatWriter> writer (format->createWriterFor (stream.get(), sampleRate, (unsigned int) numChannels,
+                                                                              bitsPerSample, reader->metadataValues, 0));
+
+    if (writer == nullptr)
+        return juce::Result::fail ("can't create a " + format->getFormatName() + " writer");
+
+    stream.release();   // the writer owns it now
+
+    // Run past the end by the processor's latency and drop that many samples
+    // from the start, so the output lines up with the input
+    juce::AudioBuffer<float> buffer (numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    auto length = reader->lengthInSamples;
+    juce::int64 readPosition = 0, written = 0;
+    auto samplesToSkip = (juce::int64) processor.getLatencySamples();
+
+    while (written < length)
+    {
+        buffer.clear();
+
+        auto numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) blockSize, length - readPosition);
+
+        if (numToRead > 0)
+            reader->read (&buffer, 0, numToRead, readPosition, true, true);
+
+        readPosition += numToRead;
+        processor.processBlock (buffer, midi);
+
+        auto skip = (int) juce::jmin (samplesToSkip, (juce::int64) blockSize);
+        auto numToWrite = (int) juce::jmin ((juce::int64) (blockSize - skip), length - written);
+        samplesToSkip -= skip;
+
+        if (numToWrite > 0 && ! writer->writeFromAudioSampleBuffer (buffer, skip, numToWrite))
+            return juce::Result::fail ("write failed");
+
+        written += numToWrite;
+    }
+
+    processor.releaseResources();
+    return juce::Result::ok();
+}
+
+void BatchRenderer::report (const Task& task, const juce::Result& result)
+{
+    const juce::ScopedLock sl (reportLock);
+
+    if (result.wasOk())
+    {
+        std::cout << "rendered " << task.input.getFullPathName() << std::endl;
+    }
+    else
+    {
+        ++numFailures;
+        std::cerr << "failed " << task.input.getFullPathName() << ": " << result.getErrorMessage() << std::endl;
+    }
+}
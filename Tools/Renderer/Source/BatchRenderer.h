@@ -0,0 +1,76 @@
+/*
+  ==============================================================================
+
+    BatchRenderer.h
+
+    Streams audio files through GraphicEqAudioProcessor offline. A fixed set
+    of worker threads, each with its own processor, pulls files off a shared
+    list until it is empty.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+
+//==============================================================================
+struct RenderOptions
+{
+    /** A blob written by GraphicEqAudioProcessor::getStateInformation(). */
+    juce::MemoryBlock state;
+
+    juce::File outputFolder;
+    int blockSize = 8192;
+    int numThreads = juce::SystemStats::getNumCpus();
+};
+
+//==============================================================================
+class BatchRenderer
+{
+public:
+    explicit BatchRenderer (RenderOptions optionsToUse);
+    ~BatchRenderer();
+
+    /** Queues a file, or every readable audio file below a folder. Output keeps
+        the path relative to the folder and the input's format. Files that would
+        be rendered onto themselves, and anything already in the output folder,
+        are skipped.
+    */
+    void addInput (const juce::File& fileOrFolder);
+
+    int getNumFiles() const noexcept    { return tasks.size(); }
+
+    /** Renders everything queued and blocks until done. Returns the number of
+        files that failed.
+    */
+    int run();
+
+private:
+    //==============================================================================
+    struct Task
+    {
+        juce::File input, output;
+    };
+
+    class Worker;
+
+    /** Queues a task unless it would write over its own input. */
+    void addTask (const Task& task);
+
+    juce::Result renderFile (GraphicEqAudioProcessor& processor, juce::AudioFormatManager& formats,
+                             const Task& task) const;
+
+    void report (const Task& task, const juce::Result& result);
+
+    //==============================================================================
+    RenderOptions options;
+    juce::AudioFormatManager formatManager;
+    juce::Array<Task> tasks;
+
+    std::atomic<int> nextTask { 0 }, numFailures { 0 };
+    juce::CriticalSection reportLock;
+
+    JUCE_DECLARE_NON_COPYABLE (BatchRenderer)
+};
@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+
+    Command line front end for BatchRenderer:
+
+        GraphicEqRenderer --state=preset.bin --output=out [--threads=n] [--block=n] inputs...
+
+    Inputs are files or folders; folders are searched recursively.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "BatchRenderer.h"
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList args (argc, argv);
+
+    if (args.size() == 0 || args.containsOption ("--help|-h"))
+    {
+        std::cout << "Usage: " << args.executableName
+                  << " --state=preset.bin --output=folder [--threads=n] [--block=n] files or folders..." << std::endl;
+        return 0;
+    }
+
+    return juce::ConsoleApplication::invokeCatchingFailures ([&]
+    {
+        RenderOptions options;
+
+        if (! args.getExistingFileForOptionAndRemove ("--state").loadFileAsData (options.state))
+            juce::ConsoleApplication::fail ("Couldn't read the state file");
+
+        options.outputFolder = args.getFileForOptionAndRemove ("--output");
+
+        if (args.containsOption ("--threads"))
+            options.numThreads = juce::jmax (1, args.removeValueForOption ("--threads").getIntValue());
+
+        if (args.containsOption ("--block"))
+            options.blockSize = juce::jlimit (64, 65536, args.removeValueForOption ("--block").getIntValue());
+
+        BatchRenderer renderer (std::move (options));
+
+        for (auto& argument : args.arguments)
+            renderer.addInput (argument.resolveAsFile());
+
+        if (renderer.getNumFiles() == 0)
+            juce::ConsoleApplication::fail ("Nothing to render");
+
+        return renderer.run() == 0 ? 0 : 1;
+    });
+}